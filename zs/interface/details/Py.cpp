@@ -1,33 +1,20 @@
 #include "Py.hpp"
+#include "PyPersistent.hpp"
 #include "zensim/zpc_tpls/whereami/whereami.h"
 
+#include <chrono>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-PyEnvInitializer::PyEnvInitializer() {
-/// preconfig (through builder initiated from static would be better)
-#if 0
-    PyPreConfig preconfig;
-    PyPreConfig_InitPythonConfig(&preconfig);
-
-    preconfig.utf8_mode = 1;
-
-    // Step 4: Apply the configuration
-    PyStatus status = Py_PreInitialize(&preconfig);
-    if (PyStatus_Exception(status)) {
-      fprintf(stderr, "Failed to preinitialize Python: %s\n", status.err_msg);
-      Py_ExitStatusException(status);
-    }
-#endif
-
-  /// initialize
-  Py_Initialize();
-
-  PyGILState_STATE gstate;
-  gstate = PyGILState_Ensure();
+using zs_startup_clock = std::chrono::steady_clock;
+static double zs_elapsed_ms(zs_startup_clock::time_point since) {
+  return std::chrono::duration<double, std::milli>(zs_startup_clock::now() - since).count();
+}
 
-  ///
+PyObject *PyEnvInitializer::bootstrap(bool verbose, ZsStartupTimings *timings) {
+  auto start = zs_startup_clock::now();
   PyObject *sysPath = PySys_GetObject("path");
   char *s{};
   int length, dirname_length;
@@ -36,64 +23,201 @@ PyEnvInitializer::PyEnvInitializer() {
   wai_getModulePath(s, length, &dirname_length);
   s[dirname_length] = '\0';
   PyList_Append(sysPath, PyUnicode_FromString(s));
-  printf("\tappending py path : [%s]\n", s);
+  if (verbose) printf("\tappending py path : [%s]\n", s);
   free(s);
+  if (timings) timings->modulePath = zs_elapsed_ms(start);
 
   /// @note
   /// https://groups.google.com/g/dev-python/c/o0e9c3kNeK4/m/q-1i77P6blwJ
   // PyImport_AddModule("__main__");
+  /// @note modules other than sys are only imported once used
+  start = zs_startup_clock::now();
   PyObject *compiledCode = Py_CompileString(R"(
-import traceback
-import subprocess
 import sys
-from io import StringIO
 zs_old_stdout = sys.stdout
 zs_old_stderr = sys.stderr
-sys.stdout = StringIO()
-sys.stderr = StringIO()
 
-from copy import deepcopy
-zs_deepcopy = deepcopy
+class zs_lazy_module:
+	def __init__(self, name):
+		self.__dict__['_zs_name'] = name
+	def __getattr__(self, attr):
+		import importlib
+		module = importlib.import_module(self._zs_name)
+		globals()[self._zs_name] = module
+		return getattr(module, attr)
+
+traceback = zs_lazy_module('traceback')
+subprocess = zs_lazy_module('subprocess')
+
+def zs_deepcopy(obj, memo=None):
+	global zs_deepcopy
+	from copy import deepcopy
+	zs_deepcopy = deepcopy
+	return deepcopy(obj, memo)
+deepcopy = zs_deepcopy
 
 def zs_install(package):
 	subprocess.check_call([sys.executable, "-m", "pip", "install", package])
 
-import faulthandler
 if __name__ == '__main__':
+	import faulthandler
 	faulthandler.enable()
 )",
                                             "<initialize>", Py_file_input);
+  PyObject *globalDict = NULL;
   if (compiledCode) {
-    g_globalDict = PyDict_New();
-    if (g_globalDict) {
-      PyDict_SetItemString(g_globalDict, "__builtins__", PyEval_GetBuiltins());
-
-      g_localDict = g_globalDict;
-      if (g_localDict) {
-        auto res = PyEval_EvalCode(compiledCode, g_globalDict, g_localDict);
-        if (res) {
-          Py_DECREF(res);
-        }
+    globalDict = PyDict_New();
+    if (globalDict) {
+      PyDict_SetItemString(globalDict, "__builtins__", PyEval_GetBuiltins());
+      auto res = PyEval_EvalCode(compiledCode, globalDict, globalDict);
+      if (res) {
+        Py_DECREF(res);
+      } else {
+        PyErr_Print();
       }
     }
     Py_DECREF(compiledCode);
   } else {
     PyErr_Print();
   }
+  if (timings) timings->bootstrap = zs_elapsed_ms(start);
+  return globalDict;
+}
 
-  PyGILState_Release(gstate);
+PyEnvInitializer::PyEnvInitializer() {
+  /// @note python is initialized on demand, see initialize()
+  g_codeCache.setBytecodeCache(&g_bytecodeCache);
   g_bufferLen = 256;
   g_buffer = (char *)malloc(sizeof(char) * g_bufferLen);
 }
 
+static bool zs_check_status(PyStatus status, const char *phase) {
+  if (!PyStatus_Exception(status)) return true;
+  fprintf(stderr, "Failed to %s python: %s\n", phase, status.err_msg ? status.err_msg : "unknown");
+  return false;
+}
+
+bool PyEnvInitializer::initialize(const ZsInterpreterConfig *config) {
+  std::lock_guard<std::recursive_mutex> lk{g_initMutex};
+  /// @note re-entrance from the initializing thread itself (e.g. GILGuard) sees a ready state
+  if (g_initialized.load(std::memory_order_acquire) || g_initializing) return true;
+  g_initializing = true;
+
+  ZsInterpreterConfig cfg;
+  zs_interpreter_config_init(&cfg);
+  if (config) cfg = *config;
+
+  const auto start = zs_startup_clock::now();
+  g_startupTimings = ZsStartupTimings{};
+  bool ownsInterpreter = false;
+  if (!Py_IsInitialized()) {
+    /// preconfig
+    auto phaseStart = zs_startup_clock::now();
+    PyPreConfig preconfig;
+    if (cfg.isolated)
+      PyPreConfig_InitIsolatedConfig(&preconfig);
+    else
+      PyPreConfig_InitPythonConfig(&preconfig);
+    if (cfg.utf8Mode >= 0) preconfig.utf8_mode = cfg.utf8Mode;
+    if (!zs_check_status(Py_PreInitialize(&preconfig), "preinitialize")) {
+      g_initializing = false;
+      return false;
+    }
+    g_startupTimings.preinitialize = zs_elapsed_ms(phaseStart);
+
+    /// initialize
+    phaseStart = zs_startup_clock::now();
+    PyConfig pyconfig;
+    if (cfg.isolated)
+      PyConfig_InitIsolatedConfig(&pyconfig);
+    else
+      PyConfig_InitPythonConfig(&pyconfig);
+    pyconfig.install_signal_handlers = cfg.installSignalHandlers;
+    pyconfig.site_import = cfg.siteImport;
+    pyconfig.parse_argv = 0;
+    bool ok = true;
+    if (cfg.home)
+      ok = zs_check_status(PyConfig_SetBytesString(&pyconfig, &pyconfig.home, cfg.home), "configure");
+    if (ok && cfg.programName)
+      ok = zs_check_status(
+          PyConfig_SetBytesString(&pyconfig, &pyconfig.program_name, cfg.programName),
+          "configure");
+    if (ok) ok = zs_check_status(Py_InitializeFromConfig(&pyconfig), "initialize");
+    PyConfig_Clear(&pyconfig);
+    if (!ok) {
+      g_initializing = false;
+      return false;
+    }
+    ownsInterpreter = true;
+    g_startupTimings.initialize = zs_elapsed_ms(phaseStart);
+  }
+
+  PyGILState_STATE gstate;
+  gstate = PyGILState_Ensure();
+
+  g_globalDict = bootstrap(cfg.verbose, &g_startupTimings);
+  g_localDict = g_globalDict;
+  if (g_globalDict) {
+    /// persistent containers for sharing pin data, see ZsPList/ZsPMap
+    auto plist = (PyObject *)zs_persistent_list_type();
+    auto pmap = (PyObject *)zs_persistent_map_type();
+    if (plist && pmap) {
+      PyDict_SetItemString(g_globalDict, "PersistentList", plist);
+      PyDict_SetItemString(g_globalDict, "PersistentMap", pmap);
+    } else
+      PyErr_Print();
+  }
+
+  /// redirect sys.stdout/sys.stderr into native ring buffers
+  auto phaseStart = zs_startup_clock::now();
+  g_stdoutBuffer.setLimit(default_output_limit);
+  g_stderrBuffer.setLimit(default_output_limit);
+  if (auto sink = static_cast<PyObject *>(zs_output_sink_obj(&g_stdoutBuffer, zs_output_stream_stdout))) {
+    PySys_SetObject("stdout", sink);
+    Py_DECREF(sink);
+  }
+  if (auto sink = static_cast<PyObject *>(zs_output_sink_obj(&g_stderrBuffer, zs_output_stream_stderr))) {
+    PySys_SetObject("stderr", sink);
+    Py_DECREF(sink);
+  }
+  g_startupTimings.outputSinks = zs_elapsed_ms(phaseStart);
+
+  PyGILState_Release(gstate);
+
+  /// Py_InitializeFromConfig() leaves the GIL held by this thread
+  if (ownsInterpreter) {
+    g_mainThreadId = std::this_thread::get_id();
+    if (cfg.releaseGIL) releaseMainThreadGIL();
+  }
+  g_startupTimings.total = zs_elapsed_ms(start);
+
+  g_initializing = false;
+  g_initialized.store(true, std::memory_order_release);
+  return true;
+}
+
+bool PyEnvInitializer::initializeOnDemand() {
+  /// @note as Py_Initialize, the thread touching python first keeps the GIL
+  return initialize(nullptr);
+}
+
 PyEnvInitializer::~PyEnvInitializer() {
   if (g_buffer) {
     free(static_cast<void *>(g_buffer));
     g_buffer = NULL;
   }
+  if (!g_initialized.load(std::memory_order_acquire)) return;
+  g_interpPool.stop();
+  g_worker.stop();
+  /// @note the saved thread state only belongs to the initializing thread
+  if (g_mainThreadState && g_mainThreadId == std::this_thread::get_id()) {
+    PyEval_RestoreThread(g_mainThreadState);
+    g_mainThreadState = NULL;
+  }
   if (g_globalDict && g_localDict) {
     PyGILState_STATE gstate;
     gstate = PyGILState_Ensure();
+    g_codeCache.clear();
     PyObject *compiledCode = Py_CompileString("sys.stdout = zs_old_stdout\n"
                                               "sys.stderr = zs_old_stderr\n",
                                               "<de-initialize>", Py_file_input);
@@ -134,9 +258,15 @@ void PyEnvInitializer::appendBuffer(const char *src,
 }
 void PyEnvInitializer::rewindBuffer() {
   g_bufferOffset = 0;
+  g_inputState.reset();
   resetInputPending();
 }
 char *PyEnvInitializer::getBuffer() { return g_buffer; }
+void PyEnvInitializer::releaseMainThreadGIL() {
+  /// @note Py_Initialize() leaves the GIL held by the initializing thread
+  if (!g_mainThreadState && g_mainThreadId == std::this_thread::get_id() && zs_gil_held())
+    g_mainThreadState = PyEval_SaveThread();
+}
 
 #ifdef __cplusplus
 }
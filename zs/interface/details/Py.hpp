@@ -1,6 +1,16 @@
 #pragma once
 #include <Python.h>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "PyCodeCache.hpp"
+#include "PyHelper.hpp"
+#include "PyInputState.hpp"
+#include "PyInterpPool.hpp"
+#include "PyWorker.hpp"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -18,6 +28,31 @@ struct PyEnvInitializer {
   unsigned long long g_bufferLen = 256;
 
   bool needMoreInput = false;
+  /// completeness of the statement being accumulated in g_buffer
+  PyInputState g_inputState;
+
+  PyCodeCache g_codeCache;
+  /// opt-in on-disk cache behind g_codeCache
+  PyBytecodeCache g_bytecodeCache;
+
+  /// captured sys.stdout / sys.stderr, bounded ring buffers
+  static constexpr unsigned long long default_output_limit = (unsigned long long)1 << 20;
+  Buffer g_stdoutBuffer;
+  Buffer g_stderrBuffer;
+
+  /// interpreter thread running async jobs
+  PyWorker g_worker;
+  /// opt-in sub-interpreters (python 3.12+)
+  PyInterpPool g_interpPool;
+  /// thread state of the initializing thread, once it gave up the GIL
+  PyThreadState *g_mainThreadState = NULL;
+  std::thread::id g_mainThreadId;
+
+  /// python is initialized on demand (explicitly or on first use), not on library load
+  std::atomic<bool> g_initialized{false};
+  bool g_initializing = false;
+  std::recursive_mutex g_initMutex;
+  ZsStartupTimings g_startupTimings{};
 
   bool pendingInput() const noexcept { return needMoreInput; }
   void setInputPending() noexcept { needMoreInput = true; }
@@ -25,11 +60,28 @@ struct PyEnvInitializer {
 
   PyEnvInitializer();
   ~PyEnvInitializer();
+  /// @brief initialize python (unless the host already did) and bootstrap the world, once
+  /// @param config NULL for zs_interpreter_config_init() defaults
+  bool initialize(const ZsInterpreterConfig *config);
+  /// @brief on-first-use initialization with default settings, the GIL is kept by the calling
+  /// thread (as with Py_Initialize)
+  bool ensureInitialized() {
+    return g_initialized.load(std::memory_order_acquire) || initializeOnDemand();
+  }
+  bool initializeOnDemand();
+  /// @brief extend sys.path and run the bootstrap script of the current interpreter
+  /// @note GIL must be held. Returns the resulting world dict (new reference), NULL on failure.
+  static PyObject *bootstrap(bool verbose, ZsStartupTimings *timings = nullptr);
   [[maybe_unused]] bool reserveBuffer(unsigned long long newLen,
                                       bool preserve = true);
   void appendBuffer(const char *src, unsigned long long numBytes);
   void rewindBuffer();
   char *getBuffer();
+  /// @brief let the initializing thread (holding the GIL since Py_Initialize) give it up, so that
+  /// other threads can run python. Python api is only accessed through GILGuard afterwards.
+  /// @note no-op unless called on the initializing thread while it holds the GIL, which must not
+  /// be nested within a GILGuard
+  void releaseMainThreadGIL();
 };
 
 #ifdef __cplusplus
@@ -0,0 +1,232 @@
+#include "PyBytecodeCache.hpp"
+
+#include <marshal.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <process.h>
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char entry_tag[8] = {'z', 's', 'c', 'o', 'd', 'e', '0', '1'};
+
+/// @note followed by the source, the filename and the marshalled code object
+struct EntryHeader {
+  char tag[8];
+  unsigned long long magic;    // PyImport_GetMagicNumber()
+  unsigned long long version;  // PY_VERSION_HEX
+  long long mode;
+  unsigned long long srcLen;
+  unsigned long long filenameLen;
+  unsigned long long codeLen;
+};
+
+unsigned long long fnv1a(const char *st, size_t len,
+                         unsigned long long h = 14695981039346656037ull) {
+  for (size_t i = 0; i != len; ++i) {
+    h ^= static_cast<unsigned char>(st[i]);
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+/// @brief read-only mapping of a whole file
+struct MappedFile {
+  explicit MappedFile(const std::string &path) {
+#ifdef _WIN32
+    _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (_file == INVALID_HANDLE_VALUE) return;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_file, &fileSize) || fileSize.QuadPart == 0) return;
+    _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!_mapping) return;
+    data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (data) size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    _fd = open(path.c_str(), O_RDONLY);
+    if (_fd < 0) return;
+    struct stat st;
+    if (fstat(_fd, &st) != 0 || st.st_size == 0) return;
+    void *ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (ptr == MAP_FAILED) return;
+    data = static_cast<const char *>(ptr);
+    size = static_cast<size_t>(st.st_size);
+#endif
+  }
+  ~MappedFile() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (_mapping) CloseHandle(_mapping);
+    if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+#else
+    if (data) munmap(const_cast<char *>(data), size);
+    if (_fd >= 0) close(_fd);
+#endif
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data = nullptr;
+  size_t size = 0;
+
+private:
+#ifdef _WIN32
+  HANDLE _file = INVALID_HANDLE_VALUE;
+  HANDLE _mapping = NULL;
+#else
+  int _fd = -1;
+#endif
+};
+
+unsigned long long process_id() {
+#ifdef _WIN32
+  return static_cast<unsigned long long>(_getpid());
+#else
+  return static_cast<unsigned long long>(getpid());
+#endif
+}
+
+}  // namespace
+
+bool PyBytecodeCache::setDirectory(const char *directory) {
+  std::lock_guard<std::mutex> lk{_mutex};
+  if (!directory || directory[0] == '\0') {
+    _enabled.store(false, std::memory_order_release);
+    _directory.clear();
+    return true;
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+  if (!std::filesystem::is_directory(directory, ec)) {
+    fprintf(stderr, "bytecode cache directory [%s] is not available\n", directory);
+    return false;
+  }
+  _directory = directory;
+  _enabled.store(true, std::memory_order_release);
+  return true;
+}
+
+std::string PyBytecodeCache::entryPath(const char *src, const char *filename, int mode) const {
+  auto h = fnv1a(src, strlen(src));
+  h = fnv1a(filename, strlen(filename) + 1, h);  // including the terminator as a separator
+  char name[96];
+  snprintf(name, sizeof(name), "%016llx-%d-%lx.zsc", h, mode,
+           static_cast<unsigned long>(PyImport_GetMagicNumber()));
+  std::lock_guard<std::mutex> lk{_mutex};
+  if (_directory.empty()) return {};
+  return (std::filesystem::path{_directory} / name).string();
+}
+
+PyObject *PyBytecodeCache::load(const char *src, const char *filename, int mode) {
+  if (!enabled()) return nullptr;
+  const auto path = entryPath(src, filename, mode);
+  if (path.empty()) return nullptr;
+
+  MappedFile file{path};
+  if (!file.data) {
+    _misses++;
+    return nullptr;
+  }
+  auto reject = [this]() -> PyObject * {
+    _rejected++;
+    _misses++;
+    return nullptr;
+  };
+  EntryHeader header;
+  if (file.size < sizeof(header)) return reject();
+  memcpy(&header, file.data, sizeof(header));
+  const size_t srcLen = strlen(src), filenameLen = strlen(filename);
+  if (memcmp(header.tag, entry_tag, sizeof(entry_tag)) != 0
+      || header.magic != static_cast<unsigned long long>(PyImport_GetMagicNumber())
+      || header.version != PY_VERSION_HEX || header.mode != mode || header.srcLen != srcLen
+      || header.filenameLen != filenameLen
+      || sizeof(header) + srcLen + filenameLen + header.codeLen != file.size)
+    return reject();
+  const char *ptr = file.data + sizeof(header);
+  if (memcmp(ptr, src, srcLen) != 0 || memcmp(ptr + srcLen, filename, filenameLen) != 0)
+    return reject();
+  ptr += srcLen + filenameLen;
+
+  PyObject *code = PyMarshal_ReadObjectFromString(ptr, static_cast<Py_ssize_t>(header.codeLen));
+  if (!code || !PyCode_Check(code)) {
+    PyErr_Clear();
+    Py_XDECREF(code);
+    return reject();
+  }
+  _hits++;
+  return code;
+}
+
+void PyBytecodeCache::store(const char *src, const char *filename, int mode, PyObject *code) {
+  if (!enabled()) return;
+  const auto path = entryPath(src, filename, mode);
+  if (path.empty()) return;
+
+  PyObject *bytes = PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION);
+  if (!bytes) {
+    PyErr_Clear();
+    return;
+  }
+  EntryHeader header;
+  memcpy(header.tag, entry_tag, sizeof(entry_tag));
+  header.magic = static_cast<unsigned long long>(PyImport_GetMagicNumber());
+  header.version = PY_VERSION_HEX;
+  header.mode = mode;
+  header.srcLen = strlen(src);
+  header.filenameLen = strlen(filename);
+  header.codeLen = static_cast<unsigned long long>(PyBytes_GET_SIZE(bytes));
+  const char *codeData = PyBytes_AS_STRING(bytes);
+
+  /// @note the marshalled bytes are immutable and kept alive, no need to hold the GIL for io
+  bool written = false;
+  Py_BEGIN_ALLOW_THREADS;
+  /// write a private temporary file, then publish it atomically. Concurrent writers of the same
+  /// entry produce identical content, whoever renames last wins.
+  static std::atomic<unsigned long long> counter{0};
+  char suffix[96];
+  snprintf(suffix, sizeof(suffix), ".%llx.%llx.%llx.tmp", process_id(),
+           static_cast<unsigned long long>(std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           counter.fetch_add(1));
+  const std::string tmpPath = path + suffix;
+  if (FILE *f = fopen(tmpPath.c_str(), "wb")) {
+    written = fwrite(&header, sizeof(header), 1, f) == 1
+              && fwrite(src, 1, header.srcLen, f) == header.srcLen
+              && fwrite(filename, 1, header.filenameLen, f) == header.filenameLen
+              && fwrite(codeData, 1, header.codeLen, f) == header.codeLen;
+    written = (fclose(f) == 0) && written;
+    std::error_code ec;
+    if (written) std::filesystem::rename(tmpPath, path, ec);
+    if (!written || ec) {
+      written = false;
+      std::filesystem::remove(tmpPath, ec);
+    }
+  }
+  Py_END_ALLOW_THREADS;
+  Py_DECREF(bytes);
+  if (written) _writes++;
+}
+
+PyBytecodeCache::Stats PyBytecodeCache::stats() const {
+  Stats ret;
+  ret.hits = _hits.load();
+  ret.misses = _misses.load();
+  ret.writes = _writes.load();
+  ret.rejected = _rejected.load();
+  return ret;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <Python.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+/**
+ *  @brief Persistent, content-addressed cache of compiled code objects in a directory
+ *  Each entry is a single file named after a hash of (source, filename, mode) and the interpreter's
+ *  bytecode magic number. It holds a header, the original source and filename (compared on load,
+ *  so hash collisions are harmless) and the marshalled code object. Entries are read through mmap
+ *  and published with an atomic rename of a uniquely named temporary file, so any number of
+ *  processes may share the directory.
+ *  @note Developer should never touch this class.
+ */
+struct PyBytecodeCache {
+  struct Stats {
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    unsigned long long writes = 0;
+    unsigned long long rejected = 0;  // stale, truncated or foreign entries
+  };
+
+  PyBytecodeCache() = default;
+  PyBytecodeCache(const PyBytecodeCache &) = delete;
+  PyBytecodeCache &operator=(const PyBytecodeCache &) = delete;
+
+  /// @brief use \a directory (created if missing), empty to disable
+  bool setDirectory(const char *directory);
+  bool enabled() const noexcept { return _enabled.load(std::memory_order_acquire); }
+
+  /// @brief load the code object compiled from \a src, NULL on miss
+  /// @note GIL must be held, returns a new reference
+  PyObject *load(const char *src, const char *filename, int mode);
+  /// @brief persist \a code compiled from \a src, failures are silently ignored
+  /// @note GIL must be held
+  void store(const char *src, const char *filename, int mode, PyObject *code);
+
+  Stats stats() const;
+
+private:
+  std::string entryPath(const char *src, const char *filename, int mode) const;
+
+  mutable std::mutex _mutex;  // guards _directory
+  std::string _directory;
+  std::atomic<bool> _enabled{false};
+  std::atomic<unsigned long long> _hits{0}, _misses{0}, _writes{0}, _rejected{0};
+};
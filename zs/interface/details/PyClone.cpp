@@ -0,0 +1,235 @@
+#include "PyClone.hpp"
+
+#include "PyPersistent.hpp"
+
+PyCloner::~PyCloner() {
+  Py_XDECREF(_keepAlive);
+  Py_XDECREF(_memo);
+  Py_XDECREF(_deepcopy);
+}
+
+bool PyCloner::atomic(PyObject *obj) noexcept {
+  PyTypeObject *tp = Py_TYPE(obj);
+  return obj == Py_None || tp == &PyLong_Type || tp == &PyFloat_Type || tp == &PyUnicode_Type
+         || tp == &PyBool_Type || tp == &PyBytes_Type || tp == &PyComplex_Type
+         || tp == &PyRange_Type || tp == &PyFunction_Type || tp == &PyCFunction_Type
+         || tp == &PyCode_Type || obj == Py_Ellipsis || obj == Py_NotImplemented
+         || PyType_Check(obj);
+}
+
+PyObject *PyCloner::memoized(PyObject *obj) {
+  if (!_memo) return nullptr;
+  PyObject *key = PyLong_FromVoidPtr(obj);
+  if (!key) return nullptr;
+  PyObject *ret = PyDict_GetItemWithError(_memo, key);
+  Py_DECREF(key);
+  return ret;
+}
+bool PyCloner::ensureMemo() {
+  if (_memo) return true;
+  if (!(_memo = PyDict_New())) return false;
+  if (!(_keepAlive = PyList_New(0))) return false;
+  /// @note same layout as copy._keep_alive, so that a python fallback shares the table
+  PyObject *memoKey = PyLong_FromVoidPtr(_memo);
+  if (!memoKey) return false;
+  int ret = PyDict_SetItem(_memo, memoKey, _keepAlive);
+  Py_DECREF(memoKey);
+  return ret == 0;
+}
+bool PyCloner::memoize(PyObject *obj, PyObject *copy) {
+  if (!ensureMemo()) return false;
+  PyObject *key = PyLong_FromVoidPtr(obj);
+  if (!key) return false;
+  int ret = PyDict_SetItem(_memo, key, copy);
+  Py_DECREF(key);
+  return ret == 0 && PyList_Append(_keepAlive, obj) == 0;
+}
+
+PyObject *PyCloner::clone(PyObject *obj) {
+  if (atomic(obj)) return Py_NewRef(obj);
+  if (PyObject *copy = memoized(obj)) return Py_NewRef(copy);
+  if (PyErr_Occurred()) return nullptr;
+
+  PyTypeObject *tp = Py_TYPE(obj);
+  const bool persistent = zs_persistent_shareable(obj) != 0;
+  if (tp != &PyTuple_Type && tp != &PyList_Type && tp != &PyDict_Type && tp != &PySet_Type
+      && !persistent)
+    return fallback(obj);
+  if (Py_EnterRecursiveCall(" while cloning an object")) return nullptr;
+  PyObject *ret;
+  if (persistent)
+    ret = clonePersistent(obj);
+  else if (tp == &PyTuple_Type)
+    ret = cloneTuple(obj);
+  else if (tp == &PyList_Type)
+    ret = cloneList(obj);
+  else if (tp == &PyDict_Type)
+    ret = cloneDict(obj);
+  else
+    ret = cloneSet(obj);
+  Py_LeaveRecursiveCall();
+  return ret;
+}
+
+PyObject *PyCloner::cloneTuple(PyObject *obj) {
+  Py_ssize_t n = PyTuple_GET_SIZE(obj);
+  PyObject *items = PyTuple_New(n);
+  if (!items) return nullptr;
+  bool shared = true;
+  for (Py_ssize_t i = 0; i != n; ++i) {
+    PyObject *item = PyTuple_GET_ITEM(obj, i);
+    PyObject *copy = clone(item);
+    if (!copy) {
+      Py_DECREF(items);
+      return nullptr;
+    }
+    shared &= copy == item;
+    PyTuple_SET_ITEM(items, i, copy);
+  }
+  /// @note a tuple reachable from its own items is memoized by the time they are copied
+  if (PyObject *copy = memoized(obj)) {
+    Py_DECREF(items);
+    return Py_NewRef(copy);
+  }
+  if (PyErr_Occurred()) {
+    Py_DECREF(items);
+    return nullptr;
+  }
+  if (shared) {
+    Py_DECREF(items);
+    return Py_NewRef(obj);
+  }
+  if (!memoize(obj, items)) {
+    Py_DECREF(items);
+    return nullptr;
+  }
+  return items;
+}
+
+PyObject *PyCloner::clonePersistent(PyObject *obj) {
+  if (zs_persistent_shareable(obj) == 1) return Py_NewRef(obj);
+  const bool isList = zs_persistent_kind(obj) == 1;
+  /// items, or (key, value) tuples which are shared back when neither side is copied
+  PyObject *items
+      = isList ? PyList_New(zs_persistent_list_size(obj)) : zs_persistent_map_items(obj);
+  if (!items) return nullptr;
+  bool shared = true;
+  for (Py_ssize_t i = 0, n = PyList_GET_SIZE(items); i != n; ++i) {
+    PyObject *item = isList ? zs_persistent_list_get(obj, i) : PyList_GET_ITEM(items, i);
+    PyObject *copy = clone(item);
+    if (!copy) {
+      Py_DECREF(items);
+      return nullptr;
+    }
+    shared &= copy == item;
+    PyList_SetItem(items, i, copy);
+  }
+  /// @note same as tuples, reachable from its own items only through mutable ones
+  PyObject *ret = memoized(obj);
+  if (ret || PyErr_Occurred()) {
+    Py_DECREF(items);
+    return Py_XNewRef(ret);
+  }
+  zs_persistent_set_shareable(obj, shared);
+  if (shared)
+    ret = Py_NewRef(obj);
+  else if ((ret = isList ? zs_persistent_list_new(items) : zs_persistent_map_new(items))
+           && !memoize(obj, ret))
+    Py_CLEAR(ret);
+  Py_DECREF(items);
+  return ret;
+}
+
+PyObject *PyCloner::cloneList(PyObject *obj) {
+  PyObject *ret = PyList_New(0);
+  if (!ret) return nullptr;
+  if (!memoize(obj, ret)) {
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  /// @note the size is re-read, fallbacks may run arbitrary code mutating the list
+  for (Py_ssize_t i = 0; i < PyList_GET_SIZE(obj); ++i) {
+    PyObject *item = Py_NewRef(PyList_GET_ITEM(obj, i));
+    PyObject *copy = clone(item);
+    Py_DECREF(item);
+    if (!copy || PyList_Append(ret, copy)) {
+      Py_XDECREF(copy);
+      Py_DECREF(ret);
+      return nullptr;
+    }
+    Py_DECREF(copy);
+  }
+  return ret;
+}
+
+PyObject *PyCloner::cloneDict(PyObject *obj) {
+  PyObject *ret = PyDict_New();
+  if (!ret) return nullptr;
+  if (!memoize(obj, ret)) {
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  Py_ssize_t pos = 0;
+  PyObject *key, *value;
+  while (PyDict_Next(obj, &pos, &key, &value)) {
+    Py_INCREF(key);
+    Py_INCREF(value);
+    PyObject *keyCopy = clone(key);
+    PyObject *valueCopy = keyCopy ? clone(value) : nullptr;
+    Py_DECREF(key);
+    Py_DECREF(value);
+    if (!valueCopy || PyDict_SetItem(ret, keyCopy, valueCopy)) {
+      Py_XDECREF(keyCopy);
+      Py_XDECREF(valueCopy);
+      Py_DECREF(ret);
+      return nullptr;
+    }
+    Py_DECREF(keyCopy);
+    Py_DECREF(valueCopy);
+  }
+  return ret;
+}
+
+PyObject *PyCloner::cloneSet(PyObject *obj) {
+  /// @note copy.deepcopy rebuilds a set from its deep-copied items (via __reduce_ex__)
+  PyObject *ret = PySet_New(NULL);
+  if (!ret) return nullptr;
+  if (!memoize(obj, ret)) {
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  PyObject *it = PyObject_GetIter(obj);
+  if (!it) {
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  while (PyObject *item = PyIter_Next(it)) {
+    PyObject *copy = clone(item);
+    Py_DECREF(item);
+    if (!copy || PySet_Add(ret, copy)) {
+      Py_XDECREF(copy);
+      Py_DECREF(it);
+      Py_DECREF(ret);
+      return nullptr;
+    }
+    Py_DECREF(copy);
+  }
+  Py_DECREF(it);
+  if (PyErr_Occurred()) {
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  return ret;
+}
+
+PyObject *PyCloner::fallback(PyObject *obj) {
+  if (!_deepcopy) {
+    /// @note held, the lazy zs_deepcopy rebinds itself on first use
+    if (!_globals || !(_deepcopy = Py_XNewRef(PyDict_GetItemString(_globals, "zs_deepcopy")))) {
+      PyErr_SetString(PyExc_RuntimeError, "zs_deepcopy is not available");
+      return nullptr;
+    }
+  }
+  if (!ensureMemo()) return nullptr;
+  return PyObject_CallFunctionObjArgs(_deepcopy, obj, _memo, NULL);
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <Python.h>
+
+/**
+ *  @brief Native deep copy of python objects, semantically equivalent to copy.deepcopy
+ *  Immutable builtins (None, bool, int, float, complex, str, bytes, types, functions), and tuples
+ *  and persistent containers of those are shared, builtin list/dict/set are copied structurally,
+ *  and everything else is handed to **zs_deepcopy** with the same memo, so that cycles spanning
+ *  both sides are preserved.
+ *  @note Developer should never touch this class. GIL must be held.
+ */
+struct PyCloner {
+  /// @param globals the dict holding **zs_deepcopy** (borrowed), only looked up on first fallback
+  explicit PyCloner(PyObject *globals) noexcept : _globals{globals} {}
+  ~PyCloner();
+  PyCloner(const PyCloner &) = delete;
+  PyCloner &operator=(const PyCloner &) = delete;
+
+  /// @return a new reference, NULL with the python error set on failure
+  PyObject *clone(PyObject *obj);
+
+  /// @brief whether \a obj is shared as is by copy.deepcopy
+  static bool atomic(PyObject *obj) noexcept;
+
+protected:
+  PyObject *cloneTuple(PyObject *obj);
+  PyObject *clonePersistent(PyObject *obj);
+  PyObject *cloneList(PyObject *obj);
+  PyObject *cloneDict(PyObject *obj);
+  PyObject *cloneSet(PyObject *obj);
+  PyObject *fallback(PyObject *obj);
+
+  bool ensureMemo();
+  /// @brief memo lookup, a borrowed reference or NULL (python error set if any)
+  PyObject *memoized(PyObject *obj);
+  /// @brief record \a copy as the copy of \a obj, keeping \a obj alive as copy.deepcopy does
+  bool memoize(PyObject *obj, PyObject *copy);
+
+  PyObject *_globals;
+  PyObject *_deepcopy = nullptr;
+  PyObject *_memo = nullptr;      // {id(obj): copy, id(memo): [obj...]}, created on demand
+  PyObject *_keepAlive = nullptr;
+};
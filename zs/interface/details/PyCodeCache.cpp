@@ -0,0 +1,182 @@
+#include "PyCodeCache.hpp"
+
+#include <string.h>
+
+PyObject *PyCodeCache::compile(const char *src, const char *filename, int mode,
+                                unsigned *flags) {
+  const Key key{std::string_view{src}, mode};
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (auto it = _lookup.find(key); it != _lookup.end()) {
+      _hits++;
+      _entries.splice(_entries.begin(), _entries, it->second);
+      if (flags) *flags = it->second->flags;
+      return Py_NewRef(it->second->code);
+    }
+    _misses++;
+  }
+
+  /// @note compile outside the lock, failures are never cached
+  const bool persistent = _bytecodeCache && mode == Py_file_input && _bytecodeCache->enabled();
+  PyObject *code = persistent ? _bytecodeCache->load(src, filename, mode) : nullptr;
+  if (!code) {
+    code = Py_CompileString(src, filename, mode);
+    if (!code) return nullptr;
+    if (persistent) _bytecodeCache->store(src, filename, mode, code);
+  }
+  /// @note only evaluated expressions care about namespace isolation
+  const unsigned codeFlags = mode == Py_eval_input ? classify(code) : code_flag_none;
+  if (flags) *flags = codeFlags;
+
+  std::list<Entry> evicted;
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_capacity == 0) return code;
+    if (auto it = _lookup.find(key); it != _lookup.end()) {
+      /// compiled concurrently by another thread (interpreter), keep the cached one
+      _entries.splice(_entries.begin(), _entries, it->second);
+      Py_DECREF(code);
+      return Py_NewRef(it->second->code);
+    }
+    shrinkTo(_capacity - 1, evicted);
+    _entries.push_front(Entry{std::string{src}, mode, codeFlags, Py_NewRef(code)});
+    /// @note the key views the string owned by the list node, which never relocates
+    _lookup.emplace(Key{_entries.front().src, mode}, _entries.begin());
+  }
+  for (auto &entry : evicted) Py_DECREF(entry.code);
+  return code;
+}
+
+static bool code_has_opcode(PyObject *code, int op) {
+  if (op < 0) return false;
+  PyObject *bytecode = PyObject_GetAttrString(code, "co_code");
+  if (!bytecode) {
+    PyErr_Clear();
+    return true;  // be conservative
+  }
+  bool ret = false;
+  char *st = nullptr;
+  Py_ssize_t len = 0;
+  if (PyBytes_AsStringAndSize(bytecode, &st, &len) == 0) {
+    /// @note 16-bit code units (opcode, oparg) since python 3.6
+    for (Py_ssize_t i = 0; i + 1 < len; i += 2)
+      if (static_cast<unsigned char>(st[i]) == op) {
+        ret = true;
+        break;
+      }
+  } else {
+    PyErr_Clear();
+    ret = true;
+  }
+  Py_DECREF(bytecode);
+  return ret;
+}
+static int lookup_opcode(const char *name) {
+  int ret = -1;
+  if (PyObject *opcodeModule = PyImport_ImportModule("opcode")) {
+    if (PyObject *opmap = PyObject_GetAttrString(opcodeModule, "opmap")) {
+      if (PyObject *op = PyDict_GetItemString(opmap, name)) ret = (int)PyLong_AsLong(op);
+      Py_DECREF(opmap);
+    }
+    Py_DECREF(opcodeModule);
+  }
+  if (PyErr_Occurred()) PyErr_Clear();
+  return ret;
+}
+
+unsigned PyCodeCache::classify(PyObject *code) {
+  static const int storeGlobalOp = lookup_opcode("STORE_GLOBAL");
+  static const int deleteGlobalOp = lookup_opcode("DELETE_GLOBAL");
+  static const int storeNameOp = lookup_opcode("STORE_NAME");
+  static const int deleteNameOp = lookup_opcode("DELETE_NAME");
+  /// @note besides the direct spellings, any reflective access (getattr, vars, frames, module
+  /// dicts) is treated as reaching globals, as are string constants naming them
+  static const char *const namespaceNames[]
+      = {"globals",  "exec",     "eval",     "__globals__", "f_globals", "getattr",
+         "vars",     "locals",   "_getframe", "f_back",     "tb_frame",  "gi_frame",
+         "cr_frame", "__dict__", "__import__"};
+  auto isNamespaceName = [](PyObject *str) {
+    const char *name = PyUnicode_AsUTF8(str);
+    if (!name) {
+      PyErr_Clear();
+      return false;
+    }
+    for (const char *nsName : namespaceNames)
+      if (!strcmp(name, nsName)) return true;
+    return false;
+  };
+
+  unsigned ret = code_flag_none;
+  if (code_has_opcode(code, storeGlobalOp) || code_has_opcode(code, deleteGlobalOp))
+    ret |= code_flag_globals_access;
+  if (code_has_opcode(code, storeNameOp) || code_has_opcode(code, deleteNameOp))
+    ret |= code_flag_store;
+
+  if (PyObject *names = PyObject_GetAttrString(code, "co_names")) {
+    if (PyTuple_Check(names)) {
+      for (Py_ssize_t i = 0, n = PyTuple_GET_SIZE(names); i != n; ++i)
+        if (isNamespaceName(PyTuple_GET_ITEM(names, i))) ret |= code_flag_globals_access;
+    }
+    Py_DECREF(names);
+  } else {
+    PyErr_Clear();
+    ret |= code_flag_globals_access;
+  }
+
+  if (PyObject *consts = PyObject_GetAttrString(code, "co_consts")) {
+    if (PyTuple_Check(consts)) {
+      for (Py_ssize_t i = 0, n = PyTuple_GET_SIZE(consts); i != n; ++i) {
+        PyObject *c = PyTuple_GET_ITEM(consts, i);
+        if (PyCode_Check(c))
+          ret |= code_flag_nested_scope | classify(c);
+        else if (PyUnicode_Check(c) && isNamespaceName(c))
+          ret |= code_flag_globals_access;
+      }
+    }
+    Py_DECREF(consts);
+  } else {
+    PyErr_Clear();
+    ret |= code_flag_nested_scope;
+  }
+  return ret;
+}
+
+void PyCodeCache::shrinkTo(unsigned long long capacity, std::list<Entry> &evicted) {
+  while (_entries.size() > capacity) {
+    auto last = std::prev(_entries.end());
+    _lookup.erase(Key{last->src, last->mode});
+    evicted.splice(evicted.end(), _entries, last);
+    _evictions++;
+  }
+}
+
+void PyCodeCache::clear() {
+  std::list<Entry> evicted;
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    _lookup.clear();
+    evicted.swap(_entries);
+  }
+  for (auto &entry : evicted) Py_DECREF(entry.code);
+}
+
+void PyCodeCache::setCapacity(unsigned long long capacity) {
+  std::list<Entry> evicted;
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    _capacity = capacity;
+    shrinkTo(capacity, evicted);
+  }
+  for (auto &entry : evicted) Py_DECREF(entry.code);
+}
+
+PyCodeCache::Stats PyCodeCache::stats() const {
+  std::lock_guard<std::mutex> lk{_mutex};
+  Stats ret;
+  ret.hits = _hits;
+  ret.misses = _misses;
+  ret.evictions = _evictions;
+  ret.size = _entries.size();
+  ret.capacity = _capacity;
+  return ret;
+}
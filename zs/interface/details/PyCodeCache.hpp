@@ -0,0 +1,92 @@
+#pragma once
+#include <Python.h>
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "PyBytecodeCache.hpp"
+
+/**
+ *  @brief Bounded LRU cache of compiled python code objects
+ *  Entries are keyed by (source text, compile mode). Bookkeeping is guarded by an internal mutex,
+ *  while the cached PyObject handles themselves are only touched with the GIL held.
+ *  @note Developer should never touch this class.
+ */
+struct PyCodeCache {
+  struct Stats {
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    unsigned long long evictions = 0;
+    unsigned long long size = 0;
+    unsigned long long capacity = 0;
+  };
+
+  /// @brief static properties of a compiled code object, computed once per cache entry
+  enum code_flag_ : unsigned {
+    code_flag_none = 0,
+    /// may reach or rebind the globals dict (globals(), exec/eval, __globals__, f_globals,
+    /// getattr/vars, frame or __dict__ access, string constants naming any of them,
+    /// STORE_GLOBAL/DELETE_GLOBAL in any nested scope)
+    /// @note a static best-effort scan of names, not a sandbox
+    code_flag_globals_access = (unsigned)1 << 0,
+    /// contains nested scopes (lambda, comprehension, ...) whose free names bypass locals
+    code_flag_nested_scope = (unsigned)1 << 1,
+    /// binds or unbinds names of its own scope (walrus, STORE_NAME/DELETE_NAME)
+    code_flag_store = (unsigned)1 << 2,
+  };
+
+  explicit PyCodeCache(unsigned long long capacity = 512) noexcept : _capacity{capacity} {}
+  /// @note cached code objects are intentionally leaked here, call clear() with the GIL held
+  /// before the interpreter goes away
+  ~PyCodeCache() = default;
+  PyCodeCache(const PyCodeCache &) = delete;
+  PyCodeCache &operator=(const PyCodeCache &) = delete;
+
+  /// @brief return a new reference of the code object compiled from \a src, compile on miss
+  /// @param flags if not NULL, receives the code_flag_ bits of the code object
+  /// @note GIL must be held. On compilation failure, NULL is returned with the python error set.
+  PyObject *compile(const char *src, const char *filename, int mode, unsigned *flags = nullptr);
+  /// @brief compute code_flag_ bits of \a code (recursing into nested code objects)
+  /// @note GIL must be held
+  static unsigned classify(PyObject *code);
+
+  /// @note GIL must be held
+  void clear();
+  /// @note GIL must be held, evicts least recently used entries if necessary
+  void setCapacity(unsigned long long capacity);
+  Stats stats() const;
+  /// @brief consult (and fill) the persistent \a cache on misses of scripts (Py_file_input)
+  void setBytecodeCache(PyBytecodeCache *cache) noexcept { _bytecodeCache = cache; }
+
+private:
+  struct Entry {
+    std::string src;
+    int mode;
+    unsigned flags;
+    PyObject *code;
+  };
+  struct Key {
+    std::string_view src;
+    int mode;
+    bool operator==(const Key &o) const noexcept { return mode == o.mode && src == o.src; }
+  };
+  struct KeyHash {
+    size_t operator()(const Key &k) const noexcept {
+      return std::hash<std::string_view>{}(k.src) ^ (static_cast<size_t>(k.mode) * 0x9e3779b9u);
+    }
+  };
+  using EntryList = std::list<Entry>;
+
+  /// @note _mutex must be locked, evicted code objects are appended to \a evicted
+  void shrinkTo(unsigned long long capacity, std::list<Entry> &evicted);
+
+  mutable std::mutex _mutex;
+  EntryList _entries;  // most recently used at front
+  std::unordered_map<Key, EntryList::iterator, KeyHash> _lookup;
+  unsigned long long _capacity;
+  unsigned long long _hits = 0, _misses = 0, _evictions = 0;
+  PyBytecodeCache *_bytecodeCache = nullptr;
+};
@@ -1,11 +1,21 @@
 #include "PyHelper.hpp"
 #include <Python.h>
 #include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+Buffer::~Buffer() {
+  free(static_cast<void *>(_buffer));
+  _buffer = nullptr;
+}
 [[maybe_unused]] bool Buffer::reserve(unsigned long long newLen,
                                       bool preserve) {
   if (newLen > _capacity) {
@@ -13,25 +23,376 @@ extern "C" {
     _capacity = newLen * 2;
     _buffer = (char *)malloc(sizeof(char) * _capacity);
     if (preserve && _offset)
-      strncpy(_buffer, oldBuffer, _offset);
+      memcpy(_buffer, oldBuffer, _offset);
     free(static_cast<void *>(oldBuffer));
     return true;
   }
   return false;
 }
 void Buffer::append(const char *src, unsigned long long numBytes) {
+  if (_limit) {
+    /// ring mode, _capacity == _limit
+    if (numBytes >= _capacity) {
+      _dropped += _offset + (numBytes - _capacity);
+      memcpy(_buffer, src + (numBytes - _capacity), _capacity);
+      _head = 0;
+      _offset = _capacity;
+      return;
+    }
+    if (_offset + numBytes > _capacity) {
+      auto overflow = _offset + numBytes - _capacity;
+      _head = (_head + overflow) % _capacity;
+      _offset -= overflow;
+      _dropped += overflow;
+    }
+    auto tail = (_head + _offset) % _capacity;
+    auto firstLen = numBytes < _capacity - tail ? numBytes : _capacity - tail;
+    memcpy(_buffer + tail, src, firstLen);
+    memcpy(_buffer, src + firstLen, numBytes - firstLen);
+    _offset += numBytes;
+    return;
+  }
   auto newOffset = _offset + numBytes;
   if (newOffset + 1 >= _capacity)
     reserve(newOffset + 1);
-  strncpy(_buffer + _offset, src, numBytes);
+  memcpy(_buffer + _offset, src, numBytes);
   _offset = newOffset;
   _buffer[newOffset] = '\0';
 }
-void Buffer::rewind() { _offset = 0; }
-char *Buffer::data() { return _buffer; }
+void Buffer::rewind() {
+  _offset = 0;
+  _head = 0;
+}
+char *Buffer::data() {
+  /// @note a ring is neither contiguous nor NULL-terminated, use view() instead
+  return _limit ? nullptr : _buffer;
+}
+
+void Buffer::setLimit(unsigned long long limit) {
+  free(static_cast<void *>(_buffer));
+  _buffer = nullptr;
+  _offset = _head = _capacity = 0;
+  _limit = limit;
+  if (_limit) {
+    _capacity = _limit;
+    _buffer = (char *)malloc(sizeof(char) * _capacity);
+  }
+}
+void Buffer::view(const char **first, unsigned long long *firstLen, const char **second,
+                  unsigned long long *secondLen) const {
+  if (_limit == 0 || _head + _offset <= _capacity) {
+    *first = _buffer + _head;
+    *firstLen = _offset;
+    *second = nullptr;
+    *secondLen = 0;
+  } else {
+    *first = _buffer + _head;
+    *firstLen = _capacity - _head;
+    *second = _buffer;
+    *secondLen = _offset - *firstLen;
+  }
+}
+void Buffer::consume(unsigned long long numBytes) {
+  if (numBytes >= _offset) {
+    rewind();
+    if (_limit == 0 && _buffer) _buffer[0] = '\0';
+  } else if (_limit) {
+    _head = (_head + numBytes) % _capacity;
+    _offset -= numBytes;
+  } else {
+    memmove(_buffer, _buffer + numBytes, _offset - numBytes + 1);  // including '\0'
+    _offset -= numBytes;
+  }
+}
+
+ByteQueue::~ByteQueue() {
+  free(static_cast<void *>(_data));
+  _data = nullptr;
+}
+void ByteQueue::reset(unsigned long long capacity) {
+  free(static_cast<void *>(_data));
+  _data = capacity ? (char *)malloc(sizeof(char) * capacity) : nullptr;
+  _capacity = _data ? capacity : 0;
+  _head.store(0, std::memory_order_relaxed);
+  _tail.store(0, std::memory_order_relaxed);
+  _dropped.store(0, std::memory_order_relaxed);
+}
+unsigned long long ByteQueue::push(const char *src, unsigned long long numBytes) {
+  auto tail = _tail.load(std::memory_order_relaxed);
+  auto head = _head.load(std::memory_order_acquire);
+  auto n = _capacity - (tail - head);
+  if (numBytes < n) n = numBytes;
+  if (n == 0) return 0;
+  auto pos = tail % _capacity;
+  auto firstLen = n < _capacity - pos ? n : _capacity - pos;
+  memcpy(_data + pos, src, firstLen);
+  memcpy(_data, src + firstLen, n - firstLen);
+  _tail.store(tail + n, std::memory_order_release);
+  return n;
+}
+unsigned long long ByteQueue::pop(char *dst, unsigned long long numBytes) {
+  auto head = _head.load(std::memory_order_relaxed);
+  auto tail = _tail.load(std::memory_order_acquire);
+  auto n = tail - head;
+  if (numBytes < n) n = numBytes;
+  if (n == 0) return 0;
+  auto pos = head % _capacity;
+  auto firstLen = n < _capacity - pos ? n : _capacity - pos;
+  memcpy(dst, _data + pos, firstLen);
+  memcpy(dst + firstLen, _data, n - firstLen);
+  _head.store(head + n, std::memory_order_release);
+  return n;
+}
+
+///
+/// output sink
+///
+struct ZsOutputSinkObject {
+  PyObject_HEAD
+  Buffer *buffer;
+  zs_output_stream_ stream;
+};
+
+/// streaming of output while python is running, configured with the GIL held
+static zs_output_callback_t g_zs_output_callback = NULL;
+static void *g_zs_output_callback_data = NULL;
+static std::atomic<bool> g_zs_output_streaming{false};
+static bool g_zs_output_stream_blocking = true;
+static ByteQueue g_zs_output_queues[2];  // stdout, stderr
+/// serializes the producers of each queue, the GIL alone does not since a producer waiting for
+/// room runs without it
+static std::mutex g_zs_output_producer_locks[2];
+/// copy of the stderr text bypassing the sink buffer (callback or streaming) while a synchronous
+/// execution is in progress, guarded by the GIL
+static std::string g_zs_stderr_copy;
+static int g_zs_stderr_copy_depth = 0;
+
+static int zs_output_queue_index(zs_output_stream_ stream) {
+  switch (stream) {
+    case zs_output_stream_stdout:
+      return 0;
+    case zs_output_stream_stderr:
+      return 1;
+    default:
+      return -1;
+  }
+}
+static ByteQueue *zs_output_queue(zs_output_stream_ stream) {
+  int i = zs_output_queue_index(stream);
+  return i >= 0 ? &g_zs_output_queues[i] : NULL;
+}
+/// @note GIL must be held. Never blocks on the lock with the GIL held, as its holder might be
+/// waiting for the GIL.
+static void zs_output_lock_producer(std::unique_lock<std::mutex> &lk) {
+  if (lk.try_lock()) return;
+  Py_BEGIN_ALLOW_THREADS;
+  lk.lock();
+  Py_END_ALLOW_THREADS;
+}
+
+/// @note GIL must be held
+static void zs_output_sink_append(ZsOutputSinkObject *sink, const char *data, sint_t len) {
+  if (g_zs_stderr_copy_depth && sink->stream == zs_output_stream_stderr
+      && (g_zs_output_callback || g_zs_output_streaming.load(std::memory_order_acquire)))
+    g_zs_stderr_copy.append(data, len);
+  if (g_zs_output_callback) {
+    g_zs_output_callback(sink->stream, data, len, g_zs_output_callback_data);
+    return;
+  }
+  const int qi = zs_output_queue_index(sink->stream);
+  if (qi >= 0 && g_zs_output_streaming.load(std::memory_order_acquire)) {
+    std::unique_lock<std::mutex> lk{g_zs_output_producer_locks[qi], std::defer_lock};
+    zs_output_lock_producer(lk);
+    ByteQueue *queue = &g_zs_output_queues[qi];
+    /// @note streaming might have been disabled while waiting for the lock
+    if (g_zs_output_streaming.load(std::memory_order_acquire)) {
+      unsigned long long numPushed = queue->push(data, len);
+      if (numPushed < (unsigned long long)len && g_zs_output_stream_blocking) {
+        /// backpressure: wait (without the GIL) for the consumer to catch up, or for streaming
+        /// to be disabled, which resets the queue once this lock is released
+        Py_BEGIN_ALLOW_THREADS;
+        while (numPushed < (unsigned long long)len
+               && g_zs_output_streaming.load(std::memory_order_acquire)) {
+          auto n = queue->push(data + numPushed, len - numPushed);
+          if (n == 0) std::this_thread::sleep_for(std::chrono::microseconds(100));
+          numPushed += n;
+        }
+        lk.unlock();
+        Py_END_ALLOW_THREADS;
+        /// the remainder goes back to the buffer if streaming got disabled meanwhile
+        if (numPushed < (unsigned long long)len)
+          sink->buffer->append(data + numPushed, len - numPushed);
+        return;
+      }
+      if (numPushed < (unsigned long long)len)
+        queue->_dropped.fetch_add(len - numPushed, std::memory_order_relaxed);
+      return;
+    }
+  }
+  sink->buffer->append(data, len);
+}
+
+static PyObject *zs_output_sink_write(PyObject *self, PyObject *arg) {
+  Py_ssize_t len = 0;
+  const char *utf8 = PyUnicode_AsUTF8AndSize(arg, &len);  // cached by compact str
+  if (!utf8) return NULL;
+  /// @note keep a reference, the GIL might be temporarily released for backpressure
+  Py_INCREF(arg);
+  zs_output_sink_append(reinterpret_cast<ZsOutputSinkObject *>(self), utf8, len);
+  Py_ssize_t numChars = PyUnicode_GetLength(arg);
+  Py_DECREF(arg);
+  return PyLong_FromSsize_t(numChars);
+}
+static PyObject *zs_output_sink_writelines(PyObject *self, PyObject *lines) {
+  PyObject *iter = PyObject_GetIter(lines);
+  if (!iter) return NULL;
+  while (PyObject *line = PyIter_Next(iter)) {
+    PyObject *ret = zs_output_sink_write(self, line);
+    Py_DECREF(line);
+    if (!ret) {
+      Py_DECREF(iter);
+      return NULL;
+    }
+    Py_DECREF(ret);
+  }
+  Py_DECREF(iter);
+  if (PyErr_Occurred()) return NULL;
+  Py_RETURN_NONE;
+}
+static PyObject *zs_output_sink_flush(PyObject *, PyObject *) { Py_RETURN_NONE; }
+static PyObject *zs_output_sink_isatty(PyObject *, PyObject *) { Py_RETURN_FALSE; }
+static PyObject *zs_output_sink_writable(PyObject *, PyObject *) { Py_RETURN_TRUE; }
+/// @note same as io.StringIO, there is no underlying file descriptor
+static PyObject *zs_output_sink_fileno(PyObject *, PyObject *) {
+  PyObject *ioModule = PyImport_ImportModule("io");
+  if (!ioModule) return NULL;
+  PyObject *unsupported = PyObject_GetAttrString(ioModule, "UnsupportedOperation");
+  Py_DECREF(ioModule);
+  if (!unsupported) return NULL;
+  PyErr_SetString(unsupported, "fileno");
+  Py_DECREF(unsupported);
+  return NULL;
+}
+static PyObject *zs_output_sink_encoding(PyObject *, void *) {
+  return PyUnicode_FromString("utf-8");
+}
+static PyObject *zs_output_sink_errors(PyObject *, void *) {
+  return PyUnicode_FromString("strict");
+}
+static PyObject *zs_output_sink_closed(PyObject *, void *) { Py_RETURN_FALSE; }
+static void zs_output_sink_dealloc(PyObject *self) {
+  PyTypeObject *tp = Py_TYPE(self);
+  PyObject_Free(self);
+  Py_DECREF(tp);
+}
+
+static PyMethodDef g_zs_output_sink_methods[] = {
+    {"write", zs_output_sink_write, METH_O, NULL},
+    {"writelines", zs_output_sink_writelines, METH_O, NULL},
+    {"flush", zs_output_sink_flush, METH_NOARGS, NULL},
+    {"isatty", zs_output_sink_isatty, METH_NOARGS, NULL},
+    {"writable", zs_output_sink_writable, METH_NOARGS, NULL},
+    {"fileno", zs_output_sink_fileno, METH_NOARGS, NULL},
+    {NULL, NULL, 0, NULL},
+};
+static PyGetSetDef g_zs_output_sink_getset[] = {
+    {"encoding", zs_output_sink_encoding, NULL, NULL, NULL},
+    {"errors", zs_output_sink_errors, NULL, NULL, NULL},
+    {"closed", zs_output_sink_closed, NULL, NULL, NULL},
+    {NULL, NULL, NULL, NULL, NULL},
+};
+static PyType_Slot g_zs_output_sink_slots[] = {
+    {Py_tp_dealloc, (void *)zs_output_sink_dealloc},
+    {Py_tp_methods, g_zs_output_sink_methods},
+    {Py_tp_getset, g_zs_output_sink_getset},
+    {0, NULL},
+};
+static PyType_Spec g_zs_output_sink_spec = {
+    "zs.OutputSink",
+    sizeof(ZsOutputSinkObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    g_zs_output_sink_slots,
+};
+static PyObject *g_zs_output_sink_type = NULL;
+
+void *zs_output_sink_obj(Buffer *buffer, zs_output_stream_ stream) {
+  if (!g_zs_output_sink_type) {
+    g_zs_output_sink_type = PyType_FromSpec(&g_zs_output_sink_spec);
+    if (!g_zs_output_sink_type) {
+      PyErr_Print();
+      return NULL;
+    }
+  }
+  auto ret = PyObject_New(ZsOutputSinkObject, (PyTypeObject *)g_zs_output_sink_type);
+  if (ret) {
+    ret->buffer = buffer;
+    ret->stream = stream;
+  }
+  return ret;
+}
+static ZsOutputSinkObject *zs_output_sink_cast(void *obj) {
+  if (obj && g_zs_output_sink_type && Py_TYPE(obj) == (PyTypeObject *)g_zs_output_sink_type)
+    return static_cast<ZsOutputSinkObject *>(obj);
+  return NULL;
+}
+Buffer *zs_output_sink_buffer(void *obj) {
+  if (auto sink = zs_output_sink_cast(obj)) return sink->buffer;
+  return NULL;
+}
+unsigned long long zs_output_sink_stream_dropped(zs_output_stream_ stream) {
+  if (ByteQueue *queue = zs_output_queue(stream))
+    return queue->_dropped.load(std::memory_order_relaxed);
+  return 0;
+}
+
+unsigned long long zs_output_sink_begin_stderr_copy() {
+  g_zs_stderr_copy_depth++;
+  return g_zs_stderr_copy.size();
+}
+void *zs_output_sink_end_stderr_copy(unsigned long long mark) {
+  PyObject *ret = nullptr;
+  if (mark < g_zs_stderr_copy.size()) {
+    ret = PyBytes_FromStringAndSize(g_zs_stderr_copy.data() + mark,
+                                    g_zs_stderr_copy.size() - mark);
+    if (!ret) PyErr_Clear();
+  }
+  if (--g_zs_stderr_copy_depth == 0)
+    g_zs_stderr_copy.clear();
+  else
+    g_zs_stderr_copy.resize(mark);
+  return ret;
+}
+
+void zs_world_set_output_callback(zs_output_callback_t callback, void *userData) {
+  GILGuard gilGuard;
+  g_zs_output_callback = callback;
+  g_zs_output_callback_data = userData;
+}
+void zs_world_enable_output_stream(unsigned long long capacity, bool blockWhenFull) {
+  GILGuard gilGuard;
+  g_zs_output_streaming.store(false, std::memory_order_release);
+  /// @note a producer blocked on a full queue leaves its wait once streaming is disabled
+  std::unique_lock<std::mutex> stdoutLock{g_zs_output_producer_locks[0], std::defer_lock};
+  std::unique_lock<std::mutex> stderrLock{g_zs_output_producer_locks[1], std::defer_lock};
+  zs_output_lock_producer(stdoutLock);
+  zs_output_lock_producer(stderrLock);
+  for (auto &queue : g_zs_output_queues) queue.reset(capacity);
+  g_zs_output_stream_blocking = blockWhenFull;
+  if (capacity) g_zs_output_streaming.store(true, std::memory_order_release);
+}
+sint_t zs_world_poll_output(zs_output_stream_ stream, char *dst, sint_t capacity) {
+  if (!g_zs_output_streaming.load(std::memory_order_acquire) || capacity <= 0) return 0;
+  if (ByteQueue *queue = zs_output_queue(stream)) return queue->pop(dst, capacity);
+  return -1;
+}
 
 void zs_print_py_cstr(const char *cstr) {
   if (auto sysStdout = PySys_GetObject("stdout")) {
+    if (auto sink = zs_output_sink_cast(sysStdout)) {
+      zs_output_sink_append(sink, cstr, strlen(cstr));
+      return;
+    }
     PyVar pystr = PyUnicode_FromString(cstr);
     PyFile_WriteObject((PyObject *)(void *)pystr, sysStdout, Py_PRINT_RAW);
   }
@@ -39,17 +400,127 @@ void zs_print_py_cstr(const char *cstr) {
 
 void zs_print_err_py_cstr(const char *cstr) {
   if (auto sysStdErr = PySys_GetObject("stderr")) {
+    if (auto sink = zs_output_sink_cast(sysStdErr)) {
+      zs_output_sink_append(sink, cstr, strlen(cstr));
+      return;
+    }
     PyVar pystr = PyUnicode_FromString(cstr);
     // PyObject_CallMethod(sysStdErr, "write", "O", pystr.handle());
     PyFile_WriteObject(as_ptr_<PyObject>(pystr), sysStdErr, Py_PRINT_RAW);
   }
 }
 
+///
+/// GIL
+///
+static std::atomic<unsigned long long> g_zs_gil_acquisitions{0};
+static std::atomic<unsigned long long> g_zs_gil_reentries{0};
+static std::atomic<unsigned long long> g_zs_gil_wait_ns{0};
+static std::atomic<unsigned long long> g_zs_gil_max_wait_ns{0};
+static std::atomic<unsigned long long> g_zs_gil_releases{0};
+static std::atomic<unsigned long long> g_zs_gil_thread_states{0};
+
+bool zs_gil_held() {
+  /// @note PyGILState_Check() is disabled (always true) once a sub-interpreter exists
+#if PY_VERSION_HEX >= 0x030D0000
+  PyThreadState *tstate = PyThreadState_GetUnchecked();
+#else
+  PyThreadState *tstate = _PyThreadState_UncheckedGet();
+#endif
+  return tstate && tstate == PyGILState_GetThisThreadState();
+}
+
+/// @brief PyGILState_Ensure() with bookkeeping
+static PyGILState_STATE zs_gil_ensure() {
+  if (zs_gil_held()) {
+    g_zs_gil_reentries.fetch_add(1, std::memory_order_relaxed);
+    return PyGILState_Ensure();
+  }
+  if (!PyGILState_GetThisThreadState())
+    g_zs_gil_thread_states.fetch_add(1, std::memory_order_relaxed);
+  const auto start = std::chrono::steady_clock::now();
+  auto ret = PyGILState_Ensure();
+  const unsigned long long waitNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::steady_clock::now() - start)
+                                        .count();
+  g_zs_gil_acquisitions.fetch_add(1, std::memory_order_relaxed);
+  g_zs_gil_wait_ns.fetch_add(waitNs, std::memory_order_relaxed);
+  auto maxWaitNs = g_zs_gil_max_wait_ns.load(std::memory_order_relaxed);
+  while (waitNs > maxWaitNs
+         && !g_zs_gil_max_wait_ns.compare_exchange_weak(maxWaitNs, waitNs,
+                                                        std::memory_order_relaxed))
+    ;
+  return ret;
+}
+
+namespace {
+  /// @brief the persistent thread state of a registered thread
+  struct WorkerThreadState {
+    ~WorkerThreadState() {
+      if (registered && Py_IsInitialized()) zs_unregister_worker_thread();
+    }
+    PyGILState_STATE state;
+    bool registered = false;
+  };
+  thread_local WorkerThreadState t_zs_worker_thread_state;
+}  // namespace
+
+bool zs_register_worker_thread() {
+  auto &self = t_zs_worker_thread_state;
+  if (self.registered) return true;
+  if (!zs_ensure_initialized()) return false;
+  /// @note the extra PyGILState_Ensure() keeps the thread state alive until unregistration
+  self.state = zs_gil_ensure();
+  self.registered = true;
+  if (self.state == PyGILState_UNLOCKED) PyEval_SaveThread();
+  return true;
+}
+void zs_unregister_worker_thread() {
+  auto &self = t_zs_worker_thread_state;
+  if (!self.registered) return;
+  self.registered = false;
+  if (self.state == PyGILState_UNLOCKED) PyEval_RestoreThread(PyGILState_GetThisThreadState());
+  /// the thread's error record is not released at thread exit
+  zs_clear_error();
+  PyGILState_Release(self.state);
+}
+
+void zs_gil_stats(ZsGilStats *stats) {
+  if (!stats) return;
+  stats->acquisitions = g_zs_gil_acquisitions.load(std::memory_order_relaxed);
+  stats->reentries = g_zs_gil_reentries.load(std::memory_order_relaxed);
+  stats->waitNs = g_zs_gil_wait_ns.load(std::memory_order_relaxed);
+  stats->maxWaitNs = g_zs_gil_max_wait_ns.load(std::memory_order_relaxed);
+  stats->releases = g_zs_gil_releases.load(std::memory_order_relaxed);
+  stats->threadStates = g_zs_gil_thread_states.load(std::memory_order_relaxed);
+}
+void zs_gil_stats_reset() {
+  g_zs_gil_acquisitions = 0;
+  g_zs_gil_reentries = 0;
+  g_zs_gil_wait_ns = 0;
+  g_zs_gil_max_wait_ns = 0;
+  g_zs_gil_releases = 0;
+  g_zs_gil_thread_states = 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
 
-GILGuard::GILGuard() { _state = PyGILState_Ensure(); }
+GILGuard::GILGuard() {
+  zs_ensure_initialized();
+  _state = zs_gil_ensure();
+}
 GILGuard::~GILGuard() {
   PyGILState_Release(static_cast<PyGILState_STATE>(_state));
+}
+
+GILRelease::GILRelease() : _state{nullptr} {
+  if (Py_IsInitialized() && zs_gil_held()) {
+    _state = PyEval_SaveThread();
+    g_zs_gil_releases.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+GILRelease::~GILRelease() {
+  if (_state) PyEval_RestoreThread(static_cast<PyThreadState *>(_state));
 }
\ No newline at end of file
@@ -1,22 +1,111 @@
 #pragma once
+#include <atomic>
+
 #include "interface/world/value_type/ValueInterface.hpp"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ *  @brief Byte buffer, either growing (default) or bounded as a ring (after setLimit())
+ *  In ring mode, the oldest bytes are dropped once more than the limit is appended, and the
+ *  readable bytes are exposed through view() as (at most) two contiguous spans without copying.
+ */
 struct Buffer {
+  Buffer() noexcept = default;
+  ~Buffer();
+  Buffer(const Buffer &) = delete;
+  Buffer &operator=(const Buffer &) = delete;
+
   [[maybe_unused]] bool reserve(unsigned long long newLen,
                                 bool preserve = true);
   void append(const char *src, unsigned long long numBytes);
   void rewind();
+  /// @brief the contiguous NULL-terminated content when not bounded, NULL in ring mode (see view())
   char *data();
 
-  char *_buffer;
-  unsigned long long _offset = 0;
+  /// @brief switch to bounded ring mode holding at most \a limit bytes (0: unbounded)
+  /// @note discards the current content
+  void setLimit(unsigned long long limit);
+  unsigned long long limit() const noexcept { return _limit; }
+  /// @brief number of readable bytes
+  unsigned long long size() const noexcept { return _offset; }
+  /// @brief number of bytes dropped due to the ring limit so far
+  unsigned long long dropped() const noexcept { return _dropped; }
+  /// @brief readable bytes in order, \a first followed by \a second
+  void view(const char **first, unsigned long long *firstLen, const char **second,
+            unsigned long long *secondLen) const;
+  /// @brief discard the oldest \a numBytes readable bytes
+  void consume(unsigned long long numBytes);
+
+  char *_buffer = nullptr;
+  unsigned long long _offset = 0;  // number of readable bytes
   unsigned long long _capacity = 0;
+  unsigned long long _head = 0;  // ring mode only, position of the oldest readable byte
+  unsigned long long _limit = 0;
+  unsigned long long _dropped = 0;
 };
 
+/**
+ *  @brief Lock-free single-producer single-consumer byte queue
+ *  The producer is python writing output, serialized by a per-stream lock held across the wait
+ *  for room, the consumer is one host thread polling without the GIL.
+ */
+struct ByteQueue {
+  ByteQueue() noexcept = default;
+  ~ByteQueue();
+  ByteQueue(const ByteQueue &) = delete;
+  ByteQueue &operator=(const ByteQueue &) = delete;
+
+  /// @note not thread-safe, neither side may be active meanwhile. 0 releases the storage.
+  void reset(unsigned long long capacity);
+  unsigned long long capacity() const noexcept { return _capacity; }
+  /// @return number of bytes actually pushed (less than \a numBytes when full)
+  unsigned long long push(const char *src, unsigned long long numBytes);
+  /// @return number of bytes actually popped
+  unsigned long long pop(char *dst, unsigned long long numBytes);
+
+  char *_data = nullptr;
+  unsigned long long _capacity = 0;
+  std::atomic<unsigned long long> _head{0};  // total bytes popped
+  std::atomic<unsigned long long> _tail{0};  // total bytes pushed
+  std::atomic<unsigned long long> _dropped{0};
+};
+
+/// @brief create a python text stream object (a write-only io.StringIO stand-in) for \a stream
+/// Written text (utf-8 encoded) goes to the registered output callback if any, otherwise to the
+/// streaming queue if enabled, otherwise is appended into \a buffer.
+/// @note GIL must be held, \a buffer must outlive the returned object
+void *zs_output_sink_obj(Buffer *buffer, zs_output_stream_ stream);
+/// @brief number of bytes of \a stream dropped by the (non-blocking) streaming queue
+unsigned long long zs_output_sink_stream_dropped(zs_output_stream_ stream);
+/// @brief retrieve the Buffer behind \a obj if it is created by zs_output_sink_obj, or NULL
+Buffer *zs_output_sink_buffer(void *obj);
+/// @brief start copying the stderr text that bypasses the sink buffer (output callback or
+/// streaming), so that a synchronous execution can still return it. Calls may nest.
+/// @note GIL must be held
+/// @return the mark to pass to zs_output_sink_end_stderr_copy
+unsigned long long zs_output_sink_begin_stderr_copy();
+/// @brief stop copying, and take the text copied since \a mark as python bytes (new reference),
+/// NULL if there is none
+/// @note GIL must be held
+void *zs_output_sink_end_stderr_copy(unsigned long long mark);
+
+/// @brief initialize python on first use, see zs_initialize
+/// @return false if python failed to initialize
+bool zs_ensure_initialized();
+/// @brief whether the calling thread currently holds the GIL through its own (PyGILState) thread
+/// state, usable while sub-interpreters exist unlike PyGILState_Check()
+bool zs_gil_held();
+/// @brief report the pending python error (if any) in place of PyErr_Print: the error is recorded
+/// as the thread's last error (see zs_last_error), then printed unless in quiet mode
+/// (see ZsQuietErrors), in which case it is only cleared
+/// @note GIL must be held
+void zs_report_error();
+/// @brief the zs_error_ code of the python exception type \a type (a PyObject *)
+unsigned zs_error_code(void *type);
+
 ZS_INTERFACE_EXPORT void zs_print_py_cstr(const char *cstr);
 ZS_INTERFACE_EXPORT void zs_print_err_py_cstr(const char *cstr);
 
@@ -26,7 +115,9 @@ ZS_INTERFACE_EXPORT void zs_print_err_py_cstr(const char *cstr);
 
 /**
  *  @brief RAII guard for holding current thread's GIL
- *  On construction, call PyGILState_Ensure().
+ *  On construction, initialize python if not yet (see zs_initialize), then call PyGILState_Ensure().
+ *  Acquisitions are counted (see zs_gil_stats), register long-living threads
+ *  (zs_register_worker_thread) to keep their thread states in between.
  *  On destruction, call PyGILState_Release() on the handled returned during construction.
  */
 struct ZS_INTERFACE_EXPORT GILGuard {
@@ -36,4 +127,19 @@ struct ZS_INTERFACE_EXPORT GILGuard {
   GILGuard(GILGuard &&) = delete;
 
   int _state;
+};
+
+/**
+ *  @brief RAII scope for releasing current thread's GIL, e.g. around heavy native work
+ *  On construction, call PyEval_SaveThread() if the GIL is held by this thread.
+ *  On destruction, call PyEval_RestoreThread() on the thread state saved during construction.
+ *  @note python objects must not be touched within the scope
+ */
+struct ZS_INTERFACE_EXPORT GILRelease {
+  GILRelease();
+  ~GILRelease();
+  GILRelease(const GILRelease &) = delete;
+  GILRelease(GILRelease &&) = delete;
+
+  void *_state;
 };
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "PyInputState.hpp"
+
+#include <string.h>
+
+void PyInputState::feed(const char *text, size_t len) {
+  /// @note as codeop, a line counts as code unless it is empty or starts with '#' once stripped
+  for (size_t i = 0; i < len && !_hasCode; ++i) {
+    const char c = text[i];
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\n') continue;
+    if (c == '#') {
+      const char *eol = static_cast<const char *>(memchr(text + i, '\n', len - i));
+      if (!eol) return;
+      i = eol - text;
+      continue;
+    }
+    _hasCode = true;
+  }
+}
+
+PyObject *PyInputState::compile(const char *source, const char *filename) {
+  /// @note as code.InteractiveConsole, the lines are joined without a trailing line break, so
+  /// that a compound statement (even on one line) is only complete after a blank line
+  size_t len = strlen(source);
+  if (len && source[len - 1] == '\n') --len;
+  PyObject *src = PyUnicode_FromStringAndSize(source, (Py_ssize_t)len);
+  if (!src) return nullptr;
+  PyObject *ret = nullptr;
+  if (PyObject *codeop = PyImport_ImportModule("codeop")) {
+    ret = PyObject_CallMethod(codeop, "compile_command", "Oss", src, filename, "single");
+    Py_DECREF(codeop);
+  }
+  Py_DECREF(src);
+  if (ret == Py_None) {
+    /// incomplete input
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  if (!ret && PyErr_ExceptionMatches(PyExc_SyntaxError)) {
+    /// the traceback only shows codeop internals
+    PyObject *type, *value, *tb;
+    PyErr_Fetch(&type, &value, &tb);
+    Py_XDECREF(tb);
+    PyErr_Restore(type, value, nullptr);
+  }
+  return ret;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <Python.h>
+#include <stddef.h>
+
+/**
+ *  @brief Completeness of interactive input, as decided by codeop.compile_command (like the
+ *  python REPL): input is complete once it compiles, pending only while the compiler reports an
+ *  unexpected end of input, and any other SyntaxError is reported right away.
+ *  Blank and comment-only input is recognized as it is fed, without calling python.
+ *  @note Developer should never touch this class.
+ */
+struct PyInputState {
+  void reset() noexcept { *this = PyInputState{}; }
+  /// @brief scan \a len chars of \a text, possibly several lines separated by '\n'
+  void feed(const char *text, size_t len);
+  /// @brief whether nothing but whitespaces and comments has been fed
+  bool blank() const noexcept { return !_hasCode; }
+
+  /// @brief compile the accumulated lines \a source (each ending with '\n') in "single" mode as
+  /// code.InteractiveConsole does through codeop.compile_command
+  /// @note GIL must be held
+  /// @return a new reference of the code object if \a source is complete, otherwise NULL, with
+  /// the python error set unless \a source is merely incomplete
+  static PyObject *compile(const char *source, const char *filename);
+
+private:
+  bool _hasCode = false;
+};
@@ -0,0 +1,119 @@
+#include "PyInterpPool.hpp"
+
+#include "Py.hpp"
+
+size_t PyInterpPool::start(size_t numInterpreters) {
+  stop();
+  if (!supported() || numInterpreters == 0) return 0;
+  /// the pooled threads attach to the main interpreter while creating theirs
+  GILRelease release;
+  std::unique_lock<std::mutex> lk{_mutex};
+  _stopping = false;
+  _numStarting = numInterpreters;
+  _threads.reserve(numInterpreters);
+  for (size_t i = 0; i != numInterpreters; ++i) _threads.emplace_back([this]() { serve(); });
+  _doneCv.wait(lk, [this]() { return _numStarting == 0; });
+  return _numRunning;
+}
+
+void PyInterpPool::stop() {
+  /// the pooled threads attach to the main interpreter again while exiting
+  GILRelease release;
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    _stopping = true;
+    threads.swap(_threads);
+  }
+  _pendingCv.notify_all();
+  for (auto &thread : threads) thread.join();
+}
+
+size_t PyInterpPool::size() const {
+  std::lock_guard<std::mutex> lk{_mutex};
+  return _numRunning;
+}
+
+bool PyInterpPool::run(const Task &task) {
+  Request request{&task};
+  std::unique_lock<std::mutex> lk{_mutex};
+  if (_stopping || _numRunning == 0) return false;
+  _requests.push_back(&request);
+  _pendingCv.notify_one();
+  _doneCv.wait(lk, [&request]() { return request.done; });
+  return true;
+}
+
+void PyInterpPool::serve() {
+#if PY_VERSION_HEX >= 0x030C0000
+  /// @note a sub-interpreter is created from a thread attached to the main interpreter
+  PyThreadState *mainState = PyThreadState_New(PyInterpreterState_Main());
+  PyEval_RestoreThread(mainState);
+
+  PyInterpreterConfig config;
+  config.use_main_obmalloc = 0;
+  config.allow_fork = 0;
+  config.allow_exec = 0;
+  config.allow_threads = 1;
+  config.allow_daemon_threads = 0;
+  config.check_multi_interp_extensions = 1;
+  config.gil = PyInterpreterConfig_OWN_GIL;
+  PyThreadState *subState = nullptr;
+  PyStatus status = Py_NewInterpreterFromConfig(&subState, &config);
+
+  if (PyStatus_Exception(status)) {
+    /// still attached to the main interpreter
+    fprintf(stderr, "failed to create sub-interpreter: %s\n",
+            status.err_msg ? status.err_msg : "unknown");
+    PyThreadState_Clear(mainState);
+    PyThreadState_DeleteCurrent();
+    std::lock_guard<std::mutex> lk{_mutex};
+    _numStarting--;
+    _doneCv.notify_all();
+    return;
+  }
+
+  /// the new interpreter's GIL is held from now on, the main one is released
+  PyObject *world = PyEnvInitializer::bootstrap(false);
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    _numStarting--;
+    if (world) _numRunning++;
+  }
+  _doneCv.notify_all();
+
+  if (world) {
+    PyCodeCache codeCache;
+    PyEval_SaveThread();
+    for (;;) {
+      Request *request = nullptr;
+      {
+        std::unique_lock<std::mutex> lk{_mutex};
+        _pendingCv.wait(lk, [this]() { return _stopping || !_requests.empty(); });
+        if (_requests.empty()) {
+          _numRunning--;
+          break;
+        }
+        request = _requests.front();
+        _requests.pop_front();
+      }
+      PyEval_RestoreThread(subState);
+      (*request->task)(world, codeCache);
+      PyEval_SaveThread();
+      {
+        std::lock_guard<std::mutex> lk{_mutex};
+        request->done = true;
+      }
+      _doneCv.notify_all();
+    }
+    PyEval_RestoreThread(subState);
+    codeCache.clear();
+    Py_DECREF(world);
+  }
+  Py_EndInterpreter(subState);
+
+  PyEval_RestoreThread(mainState);
+  PyThreadState_Clear(mainState);
+  PyThreadState_DeleteCurrent();
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <Python.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PyCodeCache.hpp"
+
+/**
+ *  @brief Pool of sub-interpreters, each owning its GIL and running on its own thread
+ *  Requires python 3.12+ (PEP 684), otherwise start() never succeeds.
+ *  @note process-wide python object caches (ZsKey, ZsAttrHandle, the external buffer type, the
+ *  persistent container types) belong to the main interpreter and must not be used by tasks.
+ *  @note Developer should never touch this class.
+ */
+struct PyInterpPool {
+  /// @brief invoked on a pooled interpreter with its GIL held, \a world is its bootstrap world dict
+  /// and \a codeCache caches code objects of that interpreter
+  using Task = std::function<void(PyObject *world, PyCodeCache &codeCache)>;
+
+  PyInterpPool() = default;
+  ~PyInterpPool() { stop(); }
+  PyInterpPool(const PyInterpPool &) = delete;
+  PyInterpPool &operator=(const PyInterpPool &) = delete;
+
+  static constexpr bool supported() noexcept {
+#if PY_VERSION_HEX >= 0x030C0000
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /// @brief (re)start the pool with \a numInterpreters interpreters
+  /// @note the GIL held by the calling thread (if any) is released meanwhile
+  /// @return number of interpreters successfully created
+  size_t start(size_t numInterpreters);
+  /// @note waits for the submitted tasks to finish, with the calling thread's GIL released
+  void stop();
+  size_t size() const;
+  /// @brief run \a task on the first free interpreter, blocks until it is done
+  /// @return false if the pool is not running
+  bool run(const Task &task);
+
+private:
+  struct Request {
+    const Task *task;
+    bool done = false;
+  };
+  /// @brief body of each pooled thread: create the interpreter, then serve requests
+  void serve();
+
+  mutable std::mutex _mutex;
+  std::condition_variable _pendingCv;
+  std::condition_variable _doneCv;
+  std::deque<Request *> _requests;
+  std::vector<std::thread> _threads;
+  size_t _numRunning = 0;
+  size_t _numStarting = 0;
+  bool _stopping = false;
+};
@@ -0,0 +1,187 @@
+#pragma once
+#include <Python.h>
+#include <string.h>
+
+#include <limits>
+#include <type_traits>
+
+/**
+ *  @brief Bulk conversion between python number containers and contiguous native arrays
+ *  Containers exposing a matching buffer (array.array, numpy arrays, memoryview...) are copied
+ *  without touching their elements, runs of exact floats in lists/tuples are read
+ *  without per-element type dispatch, anything else goes through the number protocol.
+ *  @note Developer should never touch these helpers. GIL must be held.
+ */
+
+/// @brief narrow \a v into \a out, false if it is not representable
+template <typename T, typename S> inline bool zs_numeric_narrow(S v, T &out) noexcept {
+  if constexpr (std::is_floating_point_v<T>) {
+    out = static_cast<T>(v);
+    return true;
+  } else if constexpr (std::is_floating_point_v<S>) {
+    /// @note truncates towards zero, as int(float)
+    const S upper = static_cast<S>(std::numeric_limits<T>::max() / 2 + 1) * 2;
+    if (!(v >= static_cast<S>(std::numeric_limits<T>::min()) && v < upper)) return false;
+    out = static_cast<T>(v);
+    return true;
+  } else {
+    if constexpr (std::is_signed_v<S> && !std::is_signed_v<T>)
+      if (v < 0) return false;
+    if constexpr (std::is_signed_v<S> == std::is_signed_v<T>) {
+      if (v < std::numeric_limits<T>::min() || v > std::numeric_limits<T>::max()) return false;
+    } else if constexpr (std::is_signed_v<T>) {
+      if (v > static_cast<std::make_unsigned_t<T>>(std::numeric_limits<T>::max())) return false;
+    } else {
+      if (static_cast<std::make_unsigned_t<S>>(v) > std::numeric_limits<T>::max()) return false;
+    }
+    out = static_cast<T>(v);
+    return true;
+  }
+}
+
+template <typename T, typename S>
+inline bool zs_numeric_copy(const void *src, T *dst, Py_ssize_t n) noexcept {
+  if constexpr (std::is_same_v<T, S>) {
+    memcpy(dst, src, sizeof(T) * n);
+    return true;
+  } else {
+    auto s = static_cast<const S *>(src);
+    bool ok = true;
+    for (Py_ssize_t i = 0; i != n; ++i) ok &= zs_numeric_narrow(s[i], dst[i]);
+    return ok;
+  }
+}
+
+/// @return 1 on success, 0 if the buffer format is not supported, -1 (python error set) if an
+/// element is not representable
+template <typename T>
+inline int zs_numeric_from_buffer(const Py_buffer &view, T *dst, Py_ssize_t n) noexcept {
+  const char *fmt = view.format ? view.format : "B";
+  if (*fmt == '@' || *fmt == '=') fmt++;
+  if (fmt[0] == '\0' || fmt[1] != '\0') return 0;
+  bool ok;
+  switch (fmt[0]) {
+#define ZS_NUMERIC_FORMAT(CODE, TYPE)                                  \
+  case CODE:                                                           \
+    if (view.itemsize != sizeof(TYPE)) return 0;                       \
+    ok = zs_numeric_copy<T, TYPE>(view.buf, dst, n);                   \
+    break;
+    ZS_NUMERIC_FORMAT('d', double)
+    ZS_NUMERIC_FORMAT('f', float)
+    ZS_NUMERIC_FORMAT('q', long long)
+    ZS_NUMERIC_FORMAT('Q', unsigned long long)
+    ZS_NUMERIC_FORMAT('l', long)
+    ZS_NUMERIC_FORMAT('L', unsigned long)
+    ZS_NUMERIC_FORMAT('i', int)
+    ZS_NUMERIC_FORMAT('I', unsigned int)
+    ZS_NUMERIC_FORMAT('h', short)
+    ZS_NUMERIC_FORMAT('H', unsigned short)
+    ZS_NUMERIC_FORMAT('b', signed char)
+    ZS_NUMERIC_FORMAT('B', unsigned char)
+#undef ZS_NUMERIC_FORMAT
+    default:
+      return 0;
+  }
+  if (!ok) {
+    PyErr_SetString(PyExc_OverflowError, "buffer element not representable in the target type");
+    return -1;
+  }
+  return 1;
+}
+
+/// @brief convert a single number object
+template <typename T> inline bool zs_numeric_from_obj(PyObject *item, T &out) {
+  if (PyFloat_Check(item)) {
+    if (zs_numeric_narrow(PyFloat_AS_DOUBLE(item), out)) return true;
+  } else if (PyLong_Check(item)) {
+    if constexpr (std::is_floating_point_v<T>) {
+      double v = PyLong_AsDouble(item);
+      if (v == -1.0 && PyErr_Occurred()) return false;
+      out = static_cast<T>(v);
+      return true;
+    } else {
+      long long v = PyLong_AsLongLong(item);
+      if (v == -1 && PyErr_Occurred()) return false;
+      if (zs_numeric_narrow(v, out)) return true;
+    }
+  } else {
+    /// any other number (numpy scalar, bool subclass, __index__/__float__ implementers)
+    /// @note PyNumber_Float alone would also parse str/bytes
+    PyNumberMethods *nb = Py_TYPE(item)->tp_as_number;
+    if (!nb || (!nb->nb_index && (!std::is_floating_point_v<T> || !nb->nb_float))) {
+      PyErr_Format(PyExc_TypeError, "expected a sequence of numbers, got '%.200s'",
+                   Py_TYPE(item)->tp_name);
+      return false;
+    }
+    PyObject *num = std::is_floating_point_v<T> ? PyNumber_Float(item) : PyNumber_Index(item);
+    if (!num) return false;
+    bool ok = zs_numeric_from_obj(num, out);
+    Py_DECREF(num);
+    return ok;
+  }
+  PyErr_SetString(PyExc_OverflowError, "sequence element not representable in the target type");
+  return false;
+}
+
+/// @brief convert at most \a capacity leading numbers of \a seq into \a dst
+/// @return the number of elements converted, -1 with the python error set on failure
+template <typename T>
+inline Py_ssize_t zs_numeric_from_sequence(PyObject *seq, T *dst, Py_ssize_t capacity) {
+  if (capacity < 0) capacity = 0;
+  if (!PyList_Check(seq) && !PyTuple_Check(seq) && PyObject_CheckBuffer(seq)) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(seq, &view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) == 0) {
+      Py_ssize_t n = view.itemsize ? view.len / view.itemsize : 0;
+      if (view.ndim > 1) n = 0;  // leave multi-dimensional buffers to the sequence protocol
+      if (n > capacity) n = capacity;
+      int ret = view.ndim > 1 ? 0 : zs_numeric_from_buffer(view, dst, n);
+      PyBuffer_Release(&view);
+      if (ret) return ret > 0 ? n : -1;
+    } else
+      PyErr_Clear();
+  }
+
+  PyObject *fast = PySequence_Fast(seq, "expected a sequence of numbers");
+  if (!fast) return -1;
+  Py_ssize_t n = PySequence_Fast_GET_SIZE(fast);
+  if (n > capacity) n = capacity;
+  PyObject **items = PySequence_Fast_ITEMS(fast);
+
+  /// exact floats are read directly, the first other element switches to per-element dispatch
+  /// @note ints are dispatched per element, PyLong_As* has to inspect each digit array anyway
+  Py_ssize_t i = 0;
+  bool ok = true;
+  for (; i != n && Py_TYPE(items[i]) == &PyFloat_Type; ++i)
+    ok &= zs_numeric_narrow(PyFloat_AS_DOUBLE(items[i]), dst[i]);
+  if (!ok)
+    PyErr_SetString(PyExc_OverflowError, "sequence element not representable in the target type");
+  for (; ok && i != n; ++i) ok = zs_numeric_from_obj(items[i], dst[i]);
+  Py_ssize_t ret = ok ? n : -1;
+  Py_DECREF(fast);
+  return ret;
+}
+
+/// @brief build a list (or tuple) of python numbers from \a count elements of \a src
+/// @return a new reference, NULL with the python error set on failure
+template <typename T> inline PyObject *zs_numeric_to_sequence(const T *src, Py_ssize_t count,
+                                                              bool tuple) {
+  if (count < 0) count = 0;
+  PyObject *ret = tuple ? PyTuple_New(count) : PyList_New(count);
+  if (!ret) return nullptr;
+  for (Py_ssize_t i = 0; i != count; ++i) {
+    PyObject *item;
+    if constexpr (std::is_floating_point_v<T>)
+      item = PyFloat_FromDouble(static_cast<double>(src[i]));
+    else
+      item = PyLong_FromLongLong(static_cast<long long>(src[i]));
+    if (!item) {
+      Py_DECREF(ret);
+      return nullptr;
+    }
+    if (tuple)
+      PyTuple_SET_ITEM(ret, i, item);
+    else
+      PyList_SET_ITEM(ret, i, item);
+  }
+  return ret;
+}
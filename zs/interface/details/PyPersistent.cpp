@@ -0,0 +1,1286 @@
+#include "PyPersistent.hpp"
+
+#include <utility>
+#include <vector>
+
+static int zs_popcount(unsigned int v) noexcept {
+  v = v - ((v >> 1) & 0x55555555u);
+  v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+  return (int)((((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+static PyObject *g_zs_plist_type = NULL;
+static PyObject *g_zs_plist_iter_type = NULL;
+static PyObject *g_zs_pmap_type = NULL;
+static PyObject *g_zs_pmap_iter_type = NULL;
+
+int zs_persistent_kind(PyObject *obj) noexcept {
+  PyObject *tp = (PyObject *)Py_TYPE(obj);
+  if (tp == g_zs_plist_type && tp) return 1;
+  if (tp == g_zs_pmap_type && tp) return 2;
+  return 0;
+}
+
+///
+/// persistent list (bit-partitioned vector trie)
+///
+static constexpr int zs_vec_bits = 5;
+static constexpr Py_ssize_t zs_vec_width = (Py_ssize_t)1 << zs_vec_bits;
+static constexpr Py_ssize_t zs_vec_mask = zs_vec_width - 1;
+
+/// @note leaves (level 0) hold PyObject*, inner nodes hold ZsVecNode*
+struct ZsVecNode {
+  Py_ssize_t refs = 1;
+  void *slots[zs_vec_width] = {};
+};
+
+struct ZsPListObject {
+  PyObject_HEAD
+  Py_ssize_t count;
+  int shift;        // level of root
+  ZsVecNode *root;  // NULL if all items fit in the tail
+  ZsVecNode *tail;  // the last (up to 32) items, NULL if empty
+  Py_hash_t hash;   // -1 until computed
+  int shareable;    // see zs_persistent_shareable
+};
+
+static ZsVecNode *zs_vec_ref(ZsVecNode *node) noexcept {
+  if (node) node->refs++;
+  return node;
+}
+static void zs_vec_release(ZsVecNode *node, int level) noexcept {
+  if (!node || --node->refs) return;
+  for (auto slot : node->slots) {
+    if (level == 0)
+      Py_XDECREF(static_cast<PyObject *>(slot));
+    else
+      zs_vec_release(static_cast<ZsVecNode *>(slot), level - zs_vec_bits);
+  }
+  delete node;
+}
+/// @brief a fresh node sharing the children of \a node (NULL: empty)
+static ZsVecNode *zs_vec_copy(const ZsVecNode *node, int level) {
+  auto ret = new ZsVecNode;
+  if (node)
+    for (Py_ssize_t i = 0; i != zs_vec_width; ++i) {
+      ret->slots[i] = node->slots[i];
+      if (level == 0)
+        Py_XINCREF(static_cast<PyObject *>(ret->slots[i]));
+      else
+        zs_vec_ref(static_cast<ZsVecNode *>(ret->slots[i]));
+    }
+  return ret;
+}
+/// @brief store the owned \a v into slot \a i of the fresh \a node, releasing the previous one
+static void zs_vec_replace(ZsVecNode *node, int level, Py_ssize_t i, void *v) noexcept {
+  void *old = node->slots[i];
+  node->slots[i] = v;
+  if (level == 0)
+    Py_XDECREF(static_cast<PyObject *>(old));
+  else
+    zs_vec_release(static_cast<ZsVecNode *>(old), level - zs_vec_bits);
+}
+static Py_ssize_t zs_vec_tailoff(Py_ssize_t count) noexcept {
+  return count < zs_vec_width ? 0 : ((count - 1) >> zs_vec_bits) << zs_vec_bits;
+}
+static ZsVecNode *zs_vec_leaf(const ZsPListObject *list, Py_ssize_t i) noexcept {
+  if (i >= zs_vec_tailoff(list->count)) return list->tail;
+  ZsVecNode *node = list->root;
+  for (int level = list->shift; level > 0; level -= zs_vec_bits)
+    node = static_cast<ZsVecNode *>(node->slots[(i >> level) & zs_vec_mask]);
+  return node;
+}
+static ZsVecNode *zs_vec_new_path(int level, ZsVecNode *node) {
+  if (level == 0) return node;
+  auto ret = new ZsVecNode;
+  ret->slots[0] = zs_vec_new_path(level - zs_vec_bits, node);
+  return ret;
+}
+static ZsVecNode *zs_vec_push_tail(Py_ssize_t count, int level, const ZsVecNode *parent,
+                                   ZsVecNode *tail) {
+  auto ret = zs_vec_copy(parent, level);
+  Py_ssize_t i = ((count - 1) >> level) & zs_vec_mask;
+  ZsVecNode *inserted;
+  if (level == zs_vec_bits)
+    inserted = tail;
+  else if (auto child = parent ? static_cast<const ZsVecNode *>(parent->slots[i]) : nullptr)
+    inserted = zs_vec_push_tail(count, level - zs_vec_bits, child, tail);
+  else
+    inserted = zs_vec_new_path(level - zs_vec_bits, tail);
+  zs_vec_replace(ret, level, i, inserted);
+  return ret;
+}
+static ZsVecNode *zs_vec_set(int level, const ZsVecNode *node, Py_ssize_t i, PyObject *item) {
+  auto ret = zs_vec_copy(node, level);
+  if (level == 0)
+    zs_vec_replace(ret, 0, i & zs_vec_mask, Py_NewRef(item));
+  else {
+    Py_ssize_t sub = (i >> level) & zs_vec_mask;
+    zs_vec_replace(ret, level, sub,
+                   zs_vec_set(level - zs_vec_bits,
+                              static_cast<const ZsVecNode *>(node->slots[sub]), i, item));
+  }
+  return ret;
+}
+/// @return NULL if the node becomes empty
+static ZsVecNode *zs_vec_pop_tail(Py_ssize_t count, int level, const ZsVecNode *node) {
+  Py_ssize_t sub = ((count - 2) >> level) & zs_vec_mask;
+  if (level > zs_vec_bits) {
+    auto child = zs_vec_pop_tail(count, level - zs_vec_bits,
+                                 static_cast<const ZsVecNode *>(node->slots[sub]));
+    if (!child && sub == 0) return nullptr;
+    auto ret = zs_vec_copy(node, level);
+    zs_vec_replace(ret, level, sub, child);
+    return ret;
+  }
+  if (sub == 0) return nullptr;
+  auto ret = zs_vec_copy(node, level);
+  zs_vec_replace(ret, level, sub, nullptr);
+  return ret;
+}
+
+static ZsPListObject *zs_plist_alloc() {
+  auto tp = zs_persistent_list_type();
+  if (!tp) return nullptr;
+  auto ret = PyObject_New(ZsPListObject, tp);
+  if (ret) {
+    ret->count = 0;
+    ret->shift = zs_vec_bits;
+    ret->root = nullptr;
+    ret->tail = nullptr;
+    ret->hash = -1;
+    ret->shareable = -1;
+  }
+  return ret;
+}
+/// @brief bulk construction, leaves are filled bottom-up without any path copying
+static PyObject *zs_plist_from_array(PyObject *const *items, Py_ssize_t n) {
+  auto ret = zs_plist_alloc();
+  if (!ret) return nullptr;
+  Py_ssize_t tailoff = zs_vec_tailoff(n);
+  std::vector<ZsVecNode *> nodes;
+  nodes.reserve(tailoff >> zs_vec_bits);
+  for (Py_ssize_t base = 0; base != tailoff; base += zs_vec_width) {
+    auto leaf = new ZsVecNode;
+    for (Py_ssize_t i = 0; i != zs_vec_width; ++i) leaf->slots[i] = Py_NewRef(items[base + i]);
+    nodes.push_back(leaf);
+  }
+  int shift = zs_vec_bits;
+  while ((Py_ssize_t)nodes.size() > zs_vec_width) {
+    std::vector<ZsVecNode *> parents;
+    parents.reserve((nodes.size() + zs_vec_mask) >> zs_vec_bits);
+    for (size_t i = 0; i != nodes.size(); ++i) {
+      if ((i & zs_vec_mask) == 0) parents.push_back(new ZsVecNode);
+      parents.back()->slots[i & zs_vec_mask] = nodes[i];
+    }
+    nodes = std::move(parents);
+    shift += zs_vec_bits;
+  }
+  if (!nodes.empty()) {
+    ret->root = new ZsVecNode;
+    for (size_t i = 0; i != nodes.size(); ++i) ret->root->slots[i] = nodes[i];
+  }
+  ret->shift = shift;
+  if (n > tailoff) {
+    ret->tail = new ZsVecNode;
+    for (Py_ssize_t i = tailoff; i != n; ++i) ret->tail->slots[i - tailoff] = Py_NewRef(items[i]);
+  }
+  ret->count = n;
+  return (PyObject *)ret;
+}
+
+PyObject *zs_persistent_list_new(PyObject *iterable) {
+  if (!iterable) return zs_plist_from_array(nullptr, 0);
+  PyObject *fast = PySequence_Fast(iterable, "PersistentList() expects an iterable");
+  if (!fast) return nullptr;
+  PyObject *ret = zs_plist_from_array(PySequence_Fast_ITEMS(fast), PySequence_Fast_GET_SIZE(fast));
+  Py_DECREF(fast);
+  return ret;
+}
+Py_ssize_t zs_persistent_list_size(PyObject *list) noexcept {
+  return reinterpret_cast<ZsPListObject *>(list)->count;
+}
+static bool zs_plist_index(const ZsPListObject *list, Py_ssize_t &index) {
+  if (index < 0) index += list->count;
+  if (index < 0 || index >= list->count) {
+    PyErr_SetString(PyExc_IndexError, "PersistentList index out of range");
+    return false;
+  }
+  return true;
+}
+PyObject *zs_persistent_list_get(PyObject *obj, Py_ssize_t index) {
+  auto list = reinterpret_cast<ZsPListObject *>(obj);
+  if (!zs_plist_index(list, index)) return nullptr;
+  return static_cast<PyObject *>(zs_vec_leaf(list, index)->slots[index & zs_vec_mask]);
+}
+PyObject *zs_persistent_list_set(PyObject *obj, Py_ssize_t index, PyObject *item) {
+  auto list = reinterpret_cast<ZsPListObject *>(obj);
+  if (!zs_plist_index(list, index)) return nullptr;
+  auto ret = zs_plist_alloc();
+  if (!ret) return nullptr;
+  ret->count = list->count;
+  ret->shift = list->shift;
+  if (index >= zs_vec_tailoff(list->count)) {
+    ret->root = zs_vec_ref(list->root);
+    ret->tail = zs_vec_copy(list->tail, 0);
+    zs_vec_replace(ret->tail, 0, index & zs_vec_mask, Py_NewRef(item));
+  } else {
+    ret->root = zs_vec_set(list->shift, list->root, index, item);
+    ret->tail = zs_vec_ref(list->tail);
+  }
+  return (PyObject *)ret;
+}
+PyObject *zs_persistent_list_append(PyObject *obj, PyObject *item) {
+  auto list = reinterpret_cast<ZsPListObject *>(obj);
+  auto ret = zs_plist_alloc();
+  if (!ret) return nullptr;
+  Py_ssize_t n = list->count;
+  if (n - zs_vec_tailoff(n) < zs_vec_width) {
+    ret->shift = list->shift;
+    ret->root = zs_vec_ref(list->root);
+    ret->tail = zs_vec_copy(list->tail, 0);
+    ret->tail->slots[n - zs_vec_tailoff(n)] = Py_NewRef(item);
+  } else {
+    /// full tail, pushed into the trie, which grows a level once the root overflows
+    ZsVecNode *tail = zs_vec_ref(list->tail);
+    if ((n >> zs_vec_bits) > ((Py_ssize_t)1 << list->shift)) {
+      ret->root = new ZsVecNode;
+      ret->root->slots[0] = zs_vec_ref(list->root);
+      ret->root->slots[1] = zs_vec_new_path(list->shift, tail);
+      ret->shift = list->shift + zs_vec_bits;
+    } else {
+      ret->root = zs_vec_push_tail(n, list->shift, list->root, tail);
+      ret->shift = list->shift;
+    }
+    ret->tail = new ZsVecNode;
+    ret->tail->slots[0] = Py_NewRef(item);
+  }
+  ret->count = n + 1;
+  return (PyObject *)ret;
+}
+PyObject *zs_persistent_list_pop(PyObject *obj) {
+  auto list = reinterpret_cast<ZsPListObject *>(obj);
+  Py_ssize_t n = list->count;
+  if (n == 0) {
+    PyErr_SetString(PyExc_IndexError, "pop from empty PersistentList");
+    return nullptr;
+  }
+  auto ret = zs_plist_alloc();
+  if (!ret || n == 1) return (PyObject *)ret;
+  ret->count = n - 1;
+  if (n - zs_vec_tailoff(n) > 1) {
+    ret->shift = list->shift;
+    ret->root = zs_vec_ref(list->root);
+    ret->tail = zs_vec_copy(list->tail, 0);
+    zs_vec_replace(ret->tail, 0, (n - 1) & zs_vec_mask, nullptr);
+    return (PyObject *)ret;
+  }
+  /// the last leaf of the trie becomes the tail
+  ret->tail = zs_vec_ref(zs_vec_leaf(list, n - 2));
+  ZsVecNode *root = zs_vec_pop_tail(n, list->shift, list->root);
+  int shift = list->shift;
+  if (shift > zs_vec_bits && root && !root->slots[1]) {
+    auto child = zs_vec_ref(static_cast<ZsVecNode *>(root->slots[0]));
+    zs_vec_release(root, shift);
+    root = child;
+    shift -= zs_vec_bits;
+  }
+  ret->root = root;
+  ret->shift = shift;
+  return (PyObject *)ret;
+}
+
+/// python type
+static void zs_plist_dealloc(PyObject *self) {
+  auto list = reinterpret_cast<ZsPListObject *>(self);
+  zs_vec_release(list->root, list->shift);
+  zs_vec_release(list->tail, 0);
+  PyTypeObject *tp = Py_TYPE(self);
+  PyObject_Free(self);
+  Py_DECREF(tp);
+}
+static PyObject *zs_plist_tolist(PyObject *self, PyObject * = nullptr) {
+  auto list = reinterpret_cast<ZsPListObject *>(self);
+  PyObject *ret = PyList_New(list->count);
+  if (!ret) return nullptr;
+  for (Py_ssize_t base = 0; base < list->count; base += zs_vec_width) {
+    ZsVecNode *leaf = zs_vec_leaf(list, base);
+    for (Py_ssize_t i = base; i < list->count && i < base + zs_vec_width; ++i)
+      PyList_SET_ITEM(ret, i, Py_NewRef(static_cast<PyObject *>(leaf->slots[i & zs_vec_mask])));
+  }
+  return ret;
+}
+static PyObject *zs_plist_new(PyTypeObject *, PyObject *args, PyObject *kwds) {
+  PyObject *iterable = NULL;
+  static const char *kwlist[] = {"iterable", NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:PersistentList", (char **)kwlist, &iterable))
+    return nullptr;
+  return zs_persistent_list_new(iterable);
+}
+static Py_ssize_t zs_plist_length(PyObject *self) { return zs_persistent_list_size(self); }
+/// @note negative indices are already adjusted by PySequence_GetItem
+static PyObject *zs_plist_item(PyObject *self, Py_ssize_t i) {
+  if (i < 0) {
+    PyErr_SetString(PyExc_IndexError, "PersistentList index out of range");
+    return nullptr;
+  }
+  return Py_XNewRef(zs_persistent_list_get(self, i));
+}
+static PyObject *zs_plist_subscript(PyObject *self, PyObject *key) {
+  if (PyIndex_Check(key)) {
+    Py_ssize_t i = PyNumber_AsSsize_t(key, PyExc_IndexError);
+    if (i == -1 && PyErr_Occurred()) return nullptr;
+    return Py_XNewRef(zs_persistent_list_get(self, i));
+  }
+  if (PySlice_Check(key)) {
+    Py_ssize_t start, stop, step;
+    if (PySlice_Unpack(key, &start, &stop, &step) < 0) return nullptr;
+    auto list = reinterpret_cast<ZsPListObject *>(self);
+    Py_ssize_t n = PySlice_AdjustIndices(list->count, &start, &stop, step);
+    std::vector<PyObject *> items(n);
+    for (Py_ssize_t k = 0, i = start; k != n; ++k, i += step)
+      items[k] = static_cast<PyObject *>(zs_vec_leaf(list, i)->slots[i & zs_vec_mask]);
+    return zs_plist_from_array(items.data(), n);
+  }
+  PyErr_Format(PyExc_TypeError, "PersistentList indices must be integers or slices, not %.200s",
+               Py_TYPE(key)->tp_name);
+  return nullptr;
+}
+static int zs_plist_contains(PyObject *self, PyObject *value) {
+  auto list = reinterpret_cast<ZsPListObject *>(self);
+  for (Py_ssize_t i = 0; i < list->count; ++i) {
+    PyObject *item = static_cast<PyObject *>(zs_vec_leaf(list, i)->slots[i & zs_vec_mask]);
+    Py_INCREF(item);
+    int cmp = PyObject_RichCompareBool(item, value, Py_EQ);
+    Py_DECREF(item);
+    if (cmp) return cmp;
+  }
+  return 0;
+}
+static PyObject *zs_plist_richcompare(PyObject *self, PyObject *other, int op) {
+  if ((op != Py_EQ && op != Py_NE) || !(zs_persistent_kind(other) == 1 || PyList_Check(other)))
+    Py_RETURN_NOTIMPLEMENTED;
+  if (self == other) return PyBool_FromLong(op == Py_EQ);
+  auto list = reinterpret_cast<ZsPListObject *>(self);
+  Py_ssize_t n = PyList_Check(other) ? PyList_GET_SIZE(other) : zs_persistent_list_size(other);
+  if (n != list->count) return PyBool_FromLong(op == Py_NE);
+  for (Py_ssize_t i = 0; i < list->count; ++i) {
+    if (PyList_Check(other) && i >= PyList_GET_SIZE(other)) return PyBool_FromLong(op == Py_NE);
+    PyObject *a = Py_NewRef(static_cast<PyObject *>(zs_vec_leaf(list, i)->slots[i & zs_vec_mask]));
+    PyObject *b = Py_NewRef(PyList_Check(other) ? PyList_GET_ITEM(other, i)
+                                                : zs_persistent_list_get(other, i));
+    int cmp = PyObject_RichCompareBool(a, b, Py_EQ);
+    Py_DECREF(a);
+    Py_DECREF(b);
+    if (cmp < 0) return nullptr;
+    if (!cmp) return PyBool_FromLong(op == Py_NE);
+  }
+  return PyBool_FromLong(op == Py_EQ);
+}
+static Py_hash_t zs_plist_hash(PyObject *self) {
+  auto list = reinterpret_cast<ZsPListObject *>(self);
+  if (list->hash != -1) return list->hash;
+  /// @note same mixing as the classic tuple hash
+  Py_uhash_t acc = 0x345678UL, mult = 1000003UL;
+  for (Py_ssize_t i = 0; i < list->count; ++i) {
+    auto item = static_cast<PyObject *>(zs_vec_leaf(list, i)->slots[i & zs_vec_mask]);
+    Py_hash_t h = PyObject_Hash(item);
+    if (h == -1) return -1;
+    acc = (acc ^ (Py_uhash_t)h) * mult;
+    mult += (Py_uhash_t)(82520UL + list->count + list->count);
+  }
+  acc += 97531UL;
+  if (acc == (Py_uhash_t)-1) acc = (Py_uhash_t)-2;
+  return list->hash = (Py_hash_t)acc;
+}
+static PyObject *zs_plist_repr(PyObject *self) {
+  PyObject *items = zs_plist_tolist(self);
+  if (!items) return nullptr;
+  PyObject *ret = PyUnicode_FromFormat("PersistentList(%R)", items);
+  Py_DECREF(items);
+  return ret;
+}
+static PyObject *zs_plist_iter(PyObject *self);
+
+static PyObject *zs_plist_set_method(PyObject *self, PyObject *const *args, Py_ssize_t nargs) {
+  if (nargs != 2) {
+    PyErr_SetString(PyExc_TypeError, "set() expects an index and an item");
+    return nullptr;
+  }
+  Py_ssize_t i = PyNumber_AsSsize_t(args[0], PyExc_IndexError);
+  if (i == -1 && PyErr_Occurred()) return nullptr;
+  return zs_persistent_list_set(self, i, args[1]);
+}
+static PyObject *zs_plist_append_method(PyObject *self, PyObject *item) {
+  return zs_persistent_list_append(self, item);
+}
+static PyObject *zs_plist_pop_method(PyObject *self, PyObject *) {
+  return zs_persistent_list_pop(self);
+}
+static PyObject *zs_plist_extend_method(PyObject *self, PyObject *iterable) {
+  PyObject *fast = PySequence_Fast(iterable, "extend() expects an iterable");
+  if (!fast) return nullptr;
+  auto list = reinterpret_cast<ZsPListObject *>(self);
+  Py_ssize_t n = PySequence_Fast_GET_SIZE(fast);
+  PyObject *ret;
+  if (list->count == 0) {
+    ret = zs_plist_from_array(PySequence_Fast_ITEMS(fast), n);
+  } else {
+    ret = Py_NewRef(self);
+    for (Py_ssize_t i = 0; i != n && ret; ++i) {
+      PyObject *next = zs_persistent_list_append(ret, PySequence_Fast_GET_ITEM(fast, i));
+      Py_DECREF(ret);
+      ret = next;
+    }
+  }
+  Py_DECREF(fast);
+  return ret;
+}
+static PyObject *zs_persistent_self(PyObject *self, PyObject *) { return Py_NewRef(self); }
+/// @brief self if every item deep-copies to itself, otherwise a new container of the copies
+/// @note follows copy._deepcopy_tuple, including the memo check for cycles through the items
+static PyObject *zs_persistent_deepcopy(PyObject *self, PyObject *memo) {
+  if (zs_persistent_shareable(self) == 1) return Py_NewRef(self);
+  static PyObject *deepcopy = nullptr;
+  if (!deepcopy) {
+    PyObject *copyModule = PyImport_ImportModule("copy");
+    if (!copyModule) return nullptr;
+    deepcopy = PyObject_GetAttrString(copyModule, "deepcopy");
+    Py_DECREF(copyModule);
+    if (!deepcopy) return nullptr;
+  }
+  const bool isList = zs_persistent_kind(self) == 1;
+  /// items, or (key, value) pairs
+  PyObject *items = isList ? zs_plist_tolist(self) : zs_persistent_map_items(self);
+  if (!items) return nullptr;
+  bool shared = true;
+  for (Py_ssize_t i = 0, n = PyList_GET_SIZE(items); i != n; ++i) {
+    PyObject *item = PyList_GET_ITEM(items, i);
+    PyObject *copy = PyObject_CallFunctionObjArgs(deepcopy, item, memo, NULL);
+    if (!copy) {
+      Py_DECREF(items);
+      return nullptr;
+    }
+    shared &= copy == item;
+    PyList_SetItem(items, i, copy);
+  }
+  PyObject *ret = nullptr;
+  if (memo != Py_None) {
+    PyObject *key = PyLong_FromVoidPtr(self);
+    if (!key) {
+      Py_DECREF(items);
+      return nullptr;
+    }
+    ret = PyObject_GetItem(memo, key);
+    Py_DECREF(key);
+    if (!ret) {
+      if (!PyErr_ExceptionMatches(PyExc_KeyError)) {
+        Py_DECREF(items);
+        return nullptr;
+      }
+      PyErr_Clear();
+    }
+  }
+  if (!ret) {
+    zs_persistent_set_shareable(self, shared);
+    if (shared)
+      ret = Py_NewRef(self);
+    else
+      ret = isList ? zs_persistent_list_new(items) : zs_persistent_map_new(items);
+  }
+  Py_DECREF(items);
+  return ret;
+}
+
+static PyMethodDef g_zs_plist_methods[] = {
+    {"set", (PyCFunction)(void (*)(void))zs_plist_set_method, METH_FASTCALL,
+     "set(index, item) -> a new version with item at index"},
+    {"append", zs_plist_append_method, METH_O, "append(item) -> a new version ending with item"},
+    {"pop", zs_plist_pop_method, METH_NOARGS, "pop() -> a new version without the last item"},
+    {"extend", zs_plist_extend_method, METH_O, "extend(iterable) -> a new version"},
+    {"tolist", zs_plist_tolist, METH_NOARGS, "tolist() -> a list copy of the items"},
+    {"__copy__", zs_persistent_self, METH_NOARGS, NULL},
+    {"__deepcopy__", zs_persistent_deepcopy, METH_O, NULL},
+    {NULL, NULL, 0, NULL},
+};
+static PyType_Slot g_zs_plist_slots[] = {
+    {Py_tp_dealloc, (void *)zs_plist_dealloc},
+    {Py_tp_new, (void *)zs_plist_new},
+    {Py_tp_repr, (void *)zs_plist_repr},
+    {Py_tp_hash, (void *)zs_plist_hash},
+    {Py_tp_richcompare, (void *)zs_plist_richcompare},
+    {Py_tp_iter, (void *)zs_plist_iter},
+    {Py_tp_methods, g_zs_plist_methods},
+    {Py_sq_length, (void *)zs_plist_length},
+    {Py_sq_item, (void *)zs_plist_item},
+    {Py_sq_contains, (void *)zs_plist_contains},
+    {Py_mp_length, (void *)zs_plist_length},
+    {Py_mp_subscript, (void *)zs_plist_subscript},
+    {0, NULL},
+};
+static PyType_Spec g_zs_plist_spec = {
+    "zs.PersistentList",
+    sizeof(ZsPListObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    g_zs_plist_slots,
+};
+
+/// iterator, caching the current leaf
+struct ZsPListIterObject {
+  PyObject_HEAD
+  ZsPListObject *list;
+  ZsVecNode *leaf;
+  Py_ssize_t pos;
+};
+static PyObject *zs_plist_iter_next(PyObject *self) {
+  auto it = reinterpret_cast<ZsPListIterObject *>(self);
+  if (it->pos >= it->list->count) return nullptr;
+  if (!it->leaf || (it->pos & zs_vec_mask) == 0) it->leaf = zs_vec_leaf(it->list, it->pos);
+  return Py_NewRef(static_cast<PyObject *>(it->leaf->slots[it->pos++ & zs_vec_mask]));
+}
+static void zs_plist_iter_dealloc(PyObject *self) {
+  Py_DECREF(reinterpret_cast<ZsPListIterObject *>(self)->list);
+  PyTypeObject *tp = Py_TYPE(self);
+  PyObject_Free(self);
+  Py_DECREF(tp);
+}
+static PyType_Slot g_zs_plist_iter_slots[] = {
+    {Py_tp_dealloc, (void *)zs_plist_iter_dealloc},
+    {Py_tp_iter, (void *)PyObject_SelfIter},
+    {Py_tp_iternext, (void *)zs_plist_iter_next},
+    {0, NULL},
+};
+static PyType_Spec g_zs_plist_iter_spec = {
+    "zs.PersistentListIterator",
+    sizeof(ZsPListIterObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    g_zs_plist_iter_slots,
+};
+static PyObject *zs_plist_iter(PyObject *self) {
+  if (!g_zs_plist_iter_type && !(g_zs_plist_iter_type = PyType_FromSpec(&g_zs_plist_iter_spec)))
+    return nullptr;
+  auto ret = PyObject_New(ZsPListIterObject, (PyTypeObject *)g_zs_plist_iter_type);
+  if (ret) {
+    ret->list = reinterpret_cast<ZsPListObject *>(Py_NewRef(self));
+    ret->leaf = nullptr;
+    ret->pos = 0;
+  }
+  return (PyObject *)ret;
+}
+
+PyTypeObject *zs_persistent_list_type() {
+  if (!g_zs_plist_type) g_zs_plist_type = PyType_FromSpec(&g_zs_plist_spec);
+  return (PyTypeObject *)g_zs_plist_type;
+}
+
+///
+/// persistent map (hash array mapped trie)
+///
+static constexpr int zs_map_bits = 5;
+static constexpr unsigned zs_map_mask = (1u << zs_map_bits) - 1;
+
+struct ZsMapNode;
+/// @note either a (key, value) pair or a sub-trie
+struct ZsMapEntry {
+  Py_hash_t hash;
+  PyObject *key;
+  PyObject *value;
+  ZsMapNode *child;
+};
+/// @note a collision node holds entries of the very same hash, searched linearly
+struct ZsMapNode {
+  Py_ssize_t refs = 1;
+  unsigned bitmap = 0;
+  bool collision = false;
+  Py_hash_t hash = 0;
+  std::vector<ZsMapEntry> entries;
+};
+
+struct ZsPMapObject {
+  PyObject_HEAD
+  Py_ssize_t count;
+  ZsMapNode *root;  // NULL if empty
+  Py_hash_t hash;   // -1 until computed
+  int shareable;    // see zs_persistent_shareable
+};
+
+static unsigned zs_map_frag(Py_hash_t hash, int shift) noexcept {
+  return (unsigned)(((size_t)hash >> shift) & zs_map_mask);
+}
+static ZsMapNode *zs_map_ref(ZsMapNode *node) noexcept {
+  if (node) node->refs++;
+  return node;
+}
+static void zs_map_release(ZsMapNode *node) noexcept;
+static void zs_map_entry_ref(ZsMapEntry &e) noexcept {
+  if (e.child)
+    zs_map_ref(e.child);
+  else {
+    Py_INCREF(e.key);
+    Py_INCREF(e.value);
+  }
+}
+static void zs_map_entry_release(ZsMapEntry &e) noexcept {
+  if (e.child)
+    zs_map_release(e.child);
+  else {
+    Py_DECREF(e.key);
+    Py_DECREF(e.value);
+  }
+}
+static void zs_map_release(ZsMapNode *node) noexcept {
+  if (!node || --node->refs) return;
+  for (auto &e : node->entries) zs_map_entry_release(e);
+  delete node;
+}
+/// @brief a node to modify: \a node itself while building (exclusively owned), a copy otherwise
+static ZsMapNode *zs_map_edit(ZsMapNode *node, bool transient) {
+  if (transient) return zs_map_ref(node);
+  auto ret = new ZsMapNode;
+  ret->bitmap = node->bitmap;
+  ret->collision = node->collision;
+  ret->hash = node->hash;
+  ret->entries = node->entries;
+  for (auto &e : ret->entries) zs_map_entry_ref(e);
+  return ret;
+}
+static ZsMapEntry zs_map_leaf(Py_hash_t hash, PyObject *key, PyObject *value) noexcept {
+  return ZsMapEntry{hash, Py_NewRef(key), Py_NewRef(value), nullptr};
+}
+static void zs_map_set_value(ZsMapEntry &e, PyObject *value) noexcept {
+  PyObject *old = e.value;
+  e.value = Py_NewRef(value);
+  Py_DECREF(old);
+}
+
+/// @return 1 if found (\a value set, borrowed), 0 if not, -1 on error
+static int zs_map_find(const ZsMapNode *node, Py_hash_t hash, PyObject *key, PyObject **value) {
+  for (int shift = 0; node; shift += zs_map_bits) {
+    if (node->collision) {
+      if (node->hash != hash) return 0;
+      for (auto &e : node->entries) {
+        int cmp = PyObject_RichCompareBool(e.key, key, Py_EQ);
+        if (cmp < 0) return -1;
+        if (cmp) {
+          *value = e.value;
+          return 1;
+        }
+      }
+      return 0;
+    }
+    unsigned bit = 1u << zs_map_frag(hash, shift);
+    if (!(node->bitmap & bit)) return 0;
+    auto &e = node->entries[zs_popcount(node->bitmap & (bit - 1))];
+    if (e.child) {
+      node = e.child;
+      continue;
+    }
+    if (e.hash != hash) return 0;
+    int cmp = PyObject_RichCompareBool(e.key, key, Py_EQ);
+    if (cmp < 0) return -1;
+    if (cmp) *value = e.value;
+    return cmp;
+  }
+  return 0;
+}
+/// @brief a sub-trie holding both \a e (borrowed) and the new pair
+static ZsMapNode *zs_map_merge(int shift, const ZsMapEntry &e, Py_hash_t hash, PyObject *key,
+                               PyObject *value) {
+  auto ret = new ZsMapNode;
+  if (e.hash == hash) {
+    ret->collision = true;
+    ret->hash = hash;
+    ret->entries = {zs_map_leaf(e.hash, e.key, e.value), zs_map_leaf(hash, key, value)};
+    return ret;
+  }
+  /// @note the hashes differ, so do their fragments at some shift below the hash width
+  unsigned a = zs_map_frag(e.hash, shift), b = zs_map_frag(hash, shift);
+  if (a == b) {
+    ret->bitmap = 1u << a;
+    ret->entries = {ZsMapEntry{0, nullptr, nullptr,
+                               zs_map_merge(shift + zs_map_bits, e, hash, key, value)}};
+  } else {
+    ret->bitmap = (1u << a) | (1u << b);
+    ret->entries = {zs_map_leaf(e.hash, e.key, e.value), zs_map_leaf(hash, key, value)};
+    if (b < a) std::swap(ret->entries[0], ret->entries[1]);
+  }
+  return ret;
+}
+/// @return the updated node (a new reference), NULL on error
+static ZsMapNode *zs_map_assoc(ZsMapNode *node, int shift, Py_hash_t hash, PyObject *key,
+                               PyObject *value, bool &added, bool transient) {
+  if (!node) {
+    auto ret = new ZsMapNode;
+    ret->bitmap = 1u << zs_map_frag(hash, shift);
+    ret->entries = {zs_map_leaf(hash, key, value)};
+    added = true;
+    return ret;
+  }
+  if (node->collision) {
+    if (node->hash != hash) {
+      /// nest the collision node one level down, then insert next to it
+      /// @note only the fresh wrappers are edited in place, never the collision node itself
+      auto wrapper = new ZsMapNode;
+      wrapper->bitmap = 1u << zs_map_frag(node->hash, shift);
+      wrapper->entries = {ZsMapEntry{0, nullptr, nullptr, zs_map_ref(node)}};
+      auto ret = zs_map_assoc(wrapper, shift, hash, key, value, added, true);
+      zs_map_release(wrapper);
+      return ret;
+    }
+    for (size_t i = 0; i != node->entries.size(); ++i) {
+      int cmp = PyObject_RichCompareBool(node->entries[i].key, key, Py_EQ);
+      if (cmp < 0) return nullptr;
+      if (cmp) {
+        if (node->entries[i].value == value) return zs_map_ref(node);
+        auto ret = zs_map_edit(node, transient);
+        zs_map_set_value(ret->entries[i], value);
+        return ret;
+      }
+    }
+    auto ret = zs_map_edit(node, transient);
+    ret->entries.push_back(zs_map_leaf(hash, key, value));
+    added = true;
+    return ret;
+  }
+
+  unsigned bit = 1u << zs_map_frag(hash, shift);
+  size_t idx = zs_popcount(node->bitmap & (bit - 1));
+  if (!(node->bitmap & bit)) {
+    auto ret = zs_map_edit(node, transient);
+    ret->entries.insert(ret->entries.begin() + idx, zs_map_leaf(hash, key, value));
+    ret->bitmap |= bit;
+    added = true;
+    return ret;
+  }
+  const ZsMapEntry &e = node->entries[idx];
+  if (e.child) {
+    auto child = zs_map_assoc(e.child, shift + zs_map_bits, hash, key, value, added, transient);
+    if (!child) return nullptr;
+    if (child == e.child) {
+      zs_map_release(child);
+      return zs_map_ref(node);
+    }
+    auto ret = zs_map_edit(node, transient);
+    zs_map_release(ret->entries[idx].child);
+    ret->entries[idx].child = child;
+    return ret;
+  }
+  if (e.hash == hash) {
+    int cmp = PyObject_RichCompareBool(e.key, key, Py_EQ);
+    if (cmp < 0) return nullptr;
+    if (cmp) {
+      if (e.value == value) return zs_map_ref(node);
+      auto ret = zs_map_edit(node, transient);
+      zs_map_set_value(ret->entries[idx], value);
+      return ret;
+    }
+  }
+  auto child = zs_map_merge(shift + zs_map_bits, e, hash, key, value);
+  auto ret = zs_map_edit(node, transient);
+  zs_map_entry_release(ret->entries[idx]);
+  ret->entries[idx] = ZsMapEntry{0, nullptr, nullptr, child};
+  added = true;
+  return ret;
+}
+/// @brief remove entry \a idx of \a node, NULL if nothing is left
+static ZsMapNode *zs_map_without(ZsMapNode *node, size_t idx, unsigned bit) {
+  if (node->entries.size() == 1) return nullptr;
+  auto ret = zs_map_edit(node, false);
+  zs_map_entry_release(ret->entries[idx]);
+  ret->entries.erase(ret->entries.begin() + idx);
+  ret->bitmap &= ~bit;
+  return ret;
+}
+/// @return false on error, otherwise \a out is the updated node (a new reference, NULL if empty)
+static bool zs_map_dissoc(ZsMapNode *node, int shift, Py_hash_t hash, PyObject *key,
+                          bool &removed, ZsMapNode *&out) {
+  out = nullptr;
+  if (!node) return true;
+  if (node->collision) {
+    if (node->hash == hash)
+      for (size_t i = 0; i != node->entries.size(); ++i) {
+        int cmp = PyObject_RichCompareBool(node->entries[i].key, key, Py_EQ);
+        if (cmp < 0) return false;
+        if (cmp) {
+          removed = true;
+          out = zs_map_without(node, i, 0);
+          return true;
+        }
+      }
+    out = zs_map_ref(node);
+    return true;
+  }
+  unsigned bit = 1u << zs_map_frag(hash, shift);
+  if (!(node->bitmap & bit)) {
+    out = zs_map_ref(node);
+    return true;
+  }
+  size_t idx = zs_popcount(node->bitmap & (bit - 1));
+  const ZsMapEntry &e = node->entries[idx];
+  if (e.child) {
+    ZsMapNode *child;
+    if (!zs_map_dissoc(e.child, shift + zs_map_bits, hash, key, removed, child)) return false;
+    if (child == e.child) {
+      zs_map_release(child);
+      out = zs_map_ref(node);
+    } else if (!child) {
+      out = zs_map_without(node, idx, bit);
+    } else {
+      auto ret = zs_map_edit(node, false);
+      auto &slot = ret->entries[idx];
+      zs_map_release(slot.child);
+      if (child->entries.size() == 1 && !child->entries[0].child) {
+        /// a single pair left, pulled up in place of its sub-trie
+        slot = child->entries[0];
+        zs_map_entry_ref(slot);
+        zs_map_release(child);
+      } else
+        slot.child = child;
+      out = ret;
+    }
+    return true;
+  }
+  if (e.hash == hash) {
+    int cmp = PyObject_RichCompareBool(e.key, key, Py_EQ);
+    if (cmp < 0) return false;
+    if (cmp) {
+      removed = true;
+      out = zs_map_without(node, idx, bit);
+      return true;
+    }
+  }
+  out = zs_map_ref(node);
+  return true;
+}
+
+static ZsPMapObject *zs_pmap_alloc() {
+  auto tp = zs_persistent_map_type();
+  if (!tp) return nullptr;
+  auto ret = PyObject_New(ZsPMapObject, tp);
+  if (ret) {
+    ret->count = 0;
+    ret->root = nullptr;
+    ret->hash = -1;
+    ret->shareable = -1;
+  }
+  return ret;
+}
+/// @brief insert into \a map (a fresh object nobody else refers to yet)
+static bool zs_pmap_assoc_inplace(ZsPMapObject *map, PyObject *key, PyObject *value,
+                                  bool transient) {
+  Py_hash_t hash = PyObject_Hash(key);
+  if (hash == -1) return false;
+  bool added = false;
+  auto root = zs_map_assoc(map->root, 0, hash, key, value, added, transient);
+  if (!root) return false;
+  zs_map_release(map->root);
+  map->root = root;
+  map->count += added;
+  return true;
+}
+/// @brief insert the items of \a mapping (a mapping or an iterable of pairs) into \a map
+static bool zs_pmap_update_inplace(ZsPMapObject *map, PyObject *mapping, bool transient) {
+  if (PyDict_Check(mapping)) {
+    Py_ssize_t pos = 0;
+    PyObject *key, *value;
+    while (PyDict_Next(mapping, &pos, &key, &value))
+      if (!zs_pmap_assoc_inplace(map, key, value, transient)) return false;
+    return true;
+  }
+  if (zs_persistent_kind(mapping) == 2) {
+    PyObject *items = zs_persistent_map_items(mapping);
+    if (!items) return false;
+    bool ok = zs_pmap_update_inplace(map, items, transient);
+    Py_DECREF(items);
+    return ok;
+  }
+  PyObject *keys = PyObject_HasAttrString(mapping, "keys") ? PyObject_GetAttrString(mapping, "keys")
+                                                           : nullptr;
+  if (!keys && PyErr_Occurred()) return false;
+  PyObject *it = keys ? PyObject_CallNoArgs(keys) : Py_NewRef(mapping);
+  Py_XDECREF(keys);
+  if (!it) return false;
+  PyObject *iter = PyObject_GetIter(it);
+  Py_DECREF(it);
+  if (!iter) return false;
+  bool ok = true;
+  while (PyObject *item = PyIter_Next(iter)) {
+    PyObject *key, *value;
+    if (keys) {
+      key = Py_NewRef(item);
+      value = PyObject_GetItem(mapping, key);
+    } else {
+      PyObject *pair = PySequence_Fast(item, "PersistentMap() expects pairs");
+      key = value = nullptr;
+      if (pair && PySequence_Fast_GET_SIZE(pair) == 2) {
+        key = Py_NewRef(PySequence_Fast_GET_ITEM(pair, 0));
+        value = Py_NewRef(PySequence_Fast_GET_ITEM(pair, 1));
+      } else if (pair)
+        PyErr_SetString(PyExc_ValueError, "PersistentMap() expects pairs");
+      Py_XDECREF(pair);
+    }
+    Py_DECREF(item);
+    ok = key && value && zs_pmap_assoc_inplace(map, key, value, transient);
+    Py_XDECREF(key);
+    Py_XDECREF(value);
+    if (!ok) break;
+  }
+  Py_DECREF(iter);
+  return ok && !PyErr_Occurred();
+}
+
+PyObject *zs_persistent_map_new(PyObject *mapping) {
+  auto ret = zs_pmap_alloc();
+  if (!ret) return nullptr;
+  if (mapping && !zs_pmap_update_inplace(ret, mapping, true)) {
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  return (PyObject *)ret;
+}
+Py_ssize_t zs_persistent_map_size(PyObject *map) noexcept {
+  return reinterpret_cast<ZsPMapObject *>(map)->count;
+}
+PyObject *zs_persistent_map_get(PyObject *obj, PyObject *key) {
+  Py_hash_t hash = PyObject_Hash(key);
+  if (hash == -1) return nullptr;
+  PyObject *value = nullptr;
+  if (zs_map_find(reinterpret_cast<ZsPMapObject *>(obj)->root, hash, key, &value) <= 0)
+    return nullptr;
+  return value;
+}
+PyObject *zs_persistent_map_set(PyObject *obj, PyObject *key, PyObject *value) {
+  auto map = reinterpret_cast<ZsPMapObject *>(obj);
+  Py_hash_t hash = PyObject_Hash(key);
+  if (hash == -1) return nullptr;
+  bool added = false;
+  auto root = zs_map_assoc(map->root, 0, hash, key, value, added, false);
+  if (!root) return nullptr;
+  if (root == map->root) {
+    zs_map_release(root);
+    return Py_NewRef(obj);
+  }
+  auto ret = zs_pmap_alloc();
+  if (!ret) {
+    zs_map_release(root);
+    return nullptr;
+  }
+  ret->root = root;
+  ret->count = map->count + added;
+  return (PyObject *)ret;
+}
+PyObject *zs_persistent_map_remove(PyObject *obj, PyObject *key) {
+  auto map = reinterpret_cast<ZsPMapObject *>(obj);
+  Py_hash_t hash = PyObject_Hash(key);
+  if (hash == -1) return nullptr;
+  bool removed = false;
+  ZsMapNode *root;
+  if (!zs_map_dissoc(map->root, 0, hash, key, removed, root)) return nullptr;
+  if (!removed) {
+    zs_map_release(root);
+    return Py_NewRef(obj);
+  }
+  auto ret = zs_pmap_alloc();
+  if (!ret) {
+    zs_map_release(root);
+    return nullptr;
+  }
+  ret->root = root;
+  ret->count = map->count - 1;
+  return (PyObject *)ret;
+}
+
+/// @brief visit every pair, stopping (and returning false) once \a f does
+template <typename F> static bool zs_map_visit(const ZsMapNode *node, F &&f) {
+  if (!node) return true;
+  for (auto &e : node->entries)
+    if (e.child ? !zs_map_visit(e.child, f) : !f(e.key, e.value)) return false;
+  return true;
+}
+enum zs_pmap_view_ : int { zs_pmap_view_keys, zs_pmap_view_values, zs_pmap_view_items };
+static PyObject *zs_pmap_list(PyObject *obj, zs_pmap_view_ view) {
+  auto map = reinterpret_cast<ZsPMapObject *>(obj);
+  PyObject *ret = PyList_New(map->count);
+  if (!ret) return nullptr;
+  Py_ssize_t i = 0;
+  bool ok = zs_map_visit(map->root, [&](PyObject *key, PyObject *value) {
+    PyObject *item;
+    if (view == zs_pmap_view_keys)
+      item = Py_NewRef(key);
+    else if (view == zs_pmap_view_values)
+      item = Py_NewRef(value);
+    else if (!(item = PyTuple_Pack(2, key, value)))
+      return false;
+    PyList_SET_ITEM(ret, i++, item);
+    return true;
+  });
+  if (!ok) {
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  return ret;
+}
+PyObject *zs_persistent_map_items(PyObject *map) { return zs_pmap_list(map, zs_pmap_view_items); }
+
+/// python type
+static void zs_pmap_dealloc(PyObject *self) {
+  zs_map_release(reinterpret_cast<ZsPMapObject *>(self)->root);
+  PyTypeObject *tp = Py_TYPE(self);
+  PyObject_Free(self);
+  Py_DECREF(tp);
+}
+static PyObject *zs_pmap_new(PyTypeObject *, PyObject *args, PyObject *kwds) {
+  PyObject *mapping = NULL;
+  if (!PyArg_UnpackTuple(args, "PersistentMap", 0, 1, &mapping)) return nullptr;
+  auto ret = reinterpret_cast<ZsPMapObject *>(zs_persistent_map_new(mapping));
+  if (ret && kwds && !zs_pmap_update_inplace(ret, kwds, true)) Py_CLEAR(ret);
+  return (PyObject *)ret;
+}
+static Py_ssize_t zs_pmap_length(PyObject *self) { return zs_persistent_map_size(self); }
+static PyObject *zs_pmap_subscript(PyObject *self, PyObject *key) {
+  PyObject *value = zs_persistent_map_get(self, key);
+  if (!value && !PyErr_Occurred()) PyErr_SetObject(PyExc_KeyError, key);
+  return Py_XNewRef(value);
+}
+static int zs_pmap_contains(PyObject *self, PyObject *key) {
+  if (zs_persistent_map_get(self, key)) return 1;
+  return PyErr_Occurred() ? -1 : 0;
+}
+static PyObject *zs_pmap_todict(PyObject *self, PyObject * = nullptr) {
+  PyObject *ret = PyDict_New();
+  if (!ret) return nullptr;
+  if (!zs_map_visit(reinterpret_cast<ZsPMapObject *>(self)->root,
+                    [&](PyObject *key, PyObject *value) {
+                      return PyDict_SetItem(ret, key, value) == 0;
+                    })) {
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  return ret;
+}
+static PyObject *zs_pmap_richcompare(PyObject *self, PyObject *other, int op) {
+  if ((op != Py_EQ && op != Py_NE) || !(zs_persistent_kind(other) == 2 || PyDict_Check(other)))
+    Py_RETURN_NOTIMPLEMENTED;
+  if (self == other) return PyBool_FromLong(op == Py_EQ);
+  auto map = reinterpret_cast<ZsPMapObject *>(self);
+  Py_ssize_t n = PyDict_Check(other) ? PyDict_Size(other) : zs_persistent_map_size(other);
+  if (n != map->count) return PyBool_FromLong(op == Py_NE);
+  int equal = 1;
+  bool ok = zs_map_visit(map->root, [&](PyObject *key, PyObject *value) {
+    PyObject *theirs;
+    if (PyDict_Check(other))
+      theirs = PyDict_GetItemWithError(other, key);
+    else
+      theirs = zs_persistent_map_get(other, key);
+    if (!theirs) {
+      equal = PyErr_Occurred() ? -1 : 0;
+      return false;
+    }
+    Py_INCREF(theirs);
+    equal = PyObject_RichCompareBool(value, theirs, Py_EQ);
+    Py_DECREF(theirs);
+    return equal == 1;
+  });
+  if (!ok && equal < 0) return nullptr;
+  return PyBool_FromLong((equal == 1) == (op == Py_EQ));
+}
+static Py_hash_t zs_pmap_hash(PyObject *self) {
+  auto map = reinterpret_cast<ZsPMapObject *>(self);
+  if (map->hash != -1) return map->hash;
+  /// @note order independent, as for frozenset
+  Py_uhash_t acc = 1927868237UL * (Py_uhash_t)(map->count + 1);
+  bool ok = zs_map_visit(map->root, [&](PyObject *key, PyObject *value) {
+    Py_hash_t hv = PyObject_Hash(value);
+    if (hv == -1) return false;
+    Py_uhash_t h = (Py_uhash_t)PyObject_Hash(key) * 1000003UL ^ (Py_uhash_t)hv;
+    acc ^= (h ^ (h << 16) ^ 89869747UL) * 3644798167UL;
+    return true;
+  });
+  if (!ok) return -1;
+  acc = acc * 69069U + 907133923UL;
+  if (acc == (Py_uhash_t)-1) acc = 590923713UL;
+  return map->hash = (Py_hash_t)acc;
+}
+static PyObject *zs_pmap_repr(PyObject *self) {
+  PyObject *dict = zs_pmap_todict(self);
+  if (!dict) return nullptr;
+  PyObject *ret = PyUnicode_FromFormat("PersistentMap(%R)", dict);
+  Py_DECREF(dict);
+  return ret;
+}
+static PyObject *zs_pmap_iter(PyObject *self);
+
+static PyObject *zs_pmap_get_method(PyObject *self, PyObject *const *args, Py_ssize_t nargs) {
+  if (nargs < 1 || nargs > 2) {
+    PyErr_SetString(PyExc_TypeError, "get() expects a key and an optional default");
+    return nullptr;
+  }
+  PyObject *value = zs_persistent_map_get(self, args[0]);
+  if (value) return Py_NewRef(value);
+  if (PyErr_Occurred()) return nullptr;
+  return Py_NewRef(nargs == 2 ? args[1] : Py_None);
+}
+static PyObject *zs_pmap_set_method(PyObject *self, PyObject *const *args, Py_ssize_t nargs) {
+  if (nargs != 2) {
+    PyErr_SetString(PyExc_TypeError, "set() expects a key and a value");
+    return nullptr;
+  }
+  return zs_persistent_map_set(self, args[0], args[1]);
+}
+static PyObject *zs_pmap_remove_method(PyObject *self, PyObject *key) {
+  PyObject *ret = zs_persistent_map_remove(self, key);
+  if (ret == self) {
+    Py_DECREF(ret);
+    PyErr_SetObject(PyExc_KeyError, key);
+    return nullptr;
+  }
+  return ret;
+}
+static PyObject *zs_pmap_discard_method(PyObject *self, PyObject *key) {
+  return zs_persistent_map_remove(self, key);
+}
+static PyObject *zs_pmap_update_method(PyObject *self, PyObject *mapping) {
+  auto map = reinterpret_cast<ZsPMapObject *>(self);
+  auto ret = zs_pmap_alloc();
+  if (!ret) return nullptr;
+  ret->root = zs_map_ref(map->root);
+  ret->count = map->count;
+  /// @note the root is shared with self, hence no transient edits
+  if (!zs_pmap_update_inplace(ret, mapping, false)) {
+    Py_DECREF(ret);
+    return nullptr;
+  }
+  return (PyObject *)ret;
+}
+static PyObject *zs_pmap_keys(PyObject *self, PyObject *) {
+  return zs_pmap_list(self, zs_pmap_view_keys);
+}
+static PyObject *zs_pmap_values(PyObject *self, PyObject *) {
+  return zs_pmap_list(self, zs_pmap_view_values);
+}
+static PyObject *zs_pmap_items(PyObject *self, PyObject *) {
+  return zs_pmap_list(self, zs_pmap_view_items);
+}
+
+static PyMethodDef g_zs_pmap_methods[] = {
+    {"get", (PyCFunction)(void (*)(void))zs_pmap_get_method, METH_FASTCALL,
+     "get(key, default=None) -> the value of key if present, else default"},
+    {"set", (PyCFunction)(void (*)(void))zs_pmap_set_method, METH_FASTCALL,
+     "set(key, value) -> a new version mapping key to value"},
+    {"remove", zs_pmap_remove_method, METH_O,
+     "remove(key) -> a new version without key, KeyError if missing"},
+    {"discard", zs_pmap_discard_method, METH_O, "discard(key) -> a new version without key"},
+    {"update", zs_pmap_update_method, METH_O, "update(mapping) -> a new version"},
+    {"keys", zs_pmap_keys, METH_NOARGS, "keys() -> a list of the keys"},
+    {"values", zs_pmap_values, METH_NOARGS, "values() -> a list of the values"},
+    {"items", zs_pmap_items, METH_NOARGS, "items() -> a list of (key, value) pairs"},
+    {"todict", zs_pmap_todict, METH_NOARGS, "todict() -> a dict copy of the items"},
+    {"__copy__", zs_persistent_self, METH_NOARGS, NULL},
+    {"__deepcopy__", zs_persistent_deepcopy, METH_O, NULL},
+    {NULL, NULL, 0, NULL},
+};
+static PyType_Slot g_zs_pmap_slots[] = {
+    {Py_tp_dealloc, (void *)zs_pmap_dealloc},
+    {Py_tp_new, (void *)zs_pmap_new},
+    {Py_tp_repr, (void *)zs_pmap_repr},
+    {Py_tp_hash, (void *)zs_pmap_hash},
+    {Py_tp_richcompare, (void *)zs_pmap_richcompare},
+    {Py_tp_iter, (void *)zs_pmap_iter},
+    {Py_tp_methods, g_zs_pmap_methods},
+    {Py_sq_contains, (void *)zs_pmap_contains},
+    {Py_mp_length, (void *)zs_pmap_length},
+    {Py_mp_subscript, (void *)zs_pmap_subscript},
+    {0, NULL},
+};
+static PyType_Spec g_zs_pmap_spec = {
+    "zs.PersistentMap",
+    sizeof(ZsPMapObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    g_zs_pmap_slots,
+};
+
+/// key iterator, walking the trie depth-first
+struct ZsPMapIterObject {
+  PyObject_HEAD
+  ZsPMapObject *map;
+  std::vector<std::pair<const ZsMapNode *, size_t>> *stack;
+};
+static PyObject *zs_pmap_iter_next(PyObject *self) {
+  auto it = reinterpret_cast<ZsPMapIterObject *>(self);
+  auto &stack = *it->stack;
+  while (!stack.empty()) {
+    auto &top = stack.back();
+    if (top.second == top.first->entries.size()) {
+      stack.pop_back();
+      continue;
+    }
+    auto &e = top.first->entries[top.second++];
+    if (e.child)
+      stack.emplace_back(e.child, 0);
+    else
+      return Py_NewRef(e.key);
+  }
+  return nullptr;
+}
+static void zs_pmap_iter_dealloc(PyObject *self) {
+  auto it = reinterpret_cast<ZsPMapIterObject *>(self);
+  delete it->stack;
+  Py_DECREF(it->map);
+  PyTypeObject *tp = Py_TYPE(self);
+  PyObject_Free(self);
+  Py_DECREF(tp);
+}
+static PyType_Slot g_zs_pmap_iter_slots[] = {
+    {Py_tp_dealloc, (void *)zs_pmap_iter_dealloc},
+    {Py_tp_iter, (void *)PyObject_SelfIter},
+    {Py_tp_iternext, (void *)zs_pmap_iter_next},
+    {0, NULL},
+};
+static PyType_Spec g_zs_pmap_iter_spec = {
+    "zs.PersistentMapIterator",
+    sizeof(ZsPMapIterObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    g_zs_pmap_iter_slots,
+};
+static PyObject *zs_pmap_iter(PyObject *self) {
+  if (!g_zs_pmap_iter_type && !(g_zs_pmap_iter_type = PyType_FromSpec(&g_zs_pmap_iter_spec)))
+    return nullptr;
+  auto ret = PyObject_New(ZsPMapIterObject, (PyTypeObject *)g_zs_pmap_iter_type);
+  if (ret) {
+    ret->map = reinterpret_cast<ZsPMapObject *>(Py_NewRef(self));
+    ret->stack = new std::vector<std::pair<const ZsMapNode *, size_t>>;
+    if (ret->map->root) ret->stack->emplace_back(ret->map->root, 0);
+  }
+  return (PyObject *)ret;
+}
+
+PyTypeObject *zs_persistent_map_type() {
+  if (!g_zs_pmap_type) g_zs_pmap_type = PyType_FromSpec(&g_zs_pmap_spec);
+  return (PyTypeObject *)g_zs_pmap_type;
+}
+
+int zs_persistent_shareable(PyObject *obj) noexcept {
+  switch (zs_persistent_kind(obj)) {
+    case 1:
+      return reinterpret_cast<ZsPListObject *>(obj)->shareable;
+    case 2:
+      return reinterpret_cast<ZsPMapObject *>(obj)->shareable;
+    default:
+      return 0;
+  }
+}
+void zs_persistent_set_shareable(PyObject *obj, bool shareable) noexcept {
+  switch (zs_persistent_kind(obj)) {
+    case 1:
+      reinterpret_cast<ZsPListObject *>(obj)->shareable = shareable;
+      break;
+    case 2:
+      reinterpret_cast<ZsPMapObject *>(obj)->shareable = shareable;
+      break;
+    default:;
+  }
+}
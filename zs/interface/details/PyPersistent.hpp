@@ -0,0 +1,49 @@
+#pragma once
+#include <Python.h>
+
+/**
+ *  @brief Persistent (immutable, structurally shared) containers exposed as python types
+ *  **zs.PersistentList** is a 32-way bit-partitioned vector trie with a tail, **zs.PersistentMap**
+ *  is a hash array mapped trie. Updates return new versions sharing all untouched nodes with the
+ *  old one, i.e. O(1) sharing and O(log32 n) edits.
+ *  @note Developer should never touch these helpers. GIL must be held. The types are created on
+ *  first use within the main interpreter. Being immutable, the containers are shared rather than
+ *  copied by PyCloner (and copy.deepcopy) as long as all their items are, otherwise the copy
+ *  holds deep copies of the items.
+ */
+
+/// @brief the python types, created on first call, NULL with the python error set on failure
+PyTypeObject *zs_persistent_list_type();
+PyTypeObject *zs_persistent_map_type();
+/// @brief 1 if \a obj is a persistent list, 2 if a persistent map, 0 otherwise
+/// @note never creates the types
+int zs_persistent_kind(PyObject *obj) noexcept;
+/// @brief whether deep copies may share \a obj: 1 if all its items deep-copy to themselves, 0 if
+/// not, -1 if not known yet (0 for other objects)
+/// @note the items never change, thus the result is recorded once per container
+int zs_persistent_shareable(PyObject *obj) noexcept;
+void zs_persistent_set_shareable(PyObject *obj, bool shareable) noexcept;
+
+/// @note functions below return new references (borrowed ones for lookups), NULL with the python
+/// error set on failure
+
+/// @brief a persistent list holding the items of \a iterable (empty if NULL)
+PyObject *zs_persistent_list_new(PyObject *iterable);
+Py_ssize_t zs_persistent_list_size(PyObject *list) noexcept;
+/// @brief the (borrowed) item at \a index, negative indices count from the end
+PyObject *zs_persistent_list_get(PyObject *list, Py_ssize_t index);
+PyObject *zs_persistent_list_set(PyObject *list, Py_ssize_t index, PyObject *item);
+PyObject *zs_persistent_list_append(PyObject *list, PyObject *item);
+PyObject *zs_persistent_list_pop(PyObject *list);
+
+/// @brief a persistent map holding the items of \a mapping (a mapping or an iterable of pairs,
+/// empty if NULL)
+PyObject *zs_persistent_map_new(PyObject *mapping);
+Py_ssize_t zs_persistent_map_size(PyObject *map) noexcept;
+/// @brief the (borrowed) value of \a key, NULL without error if missing
+PyObject *zs_persistent_map_get(PyObject *map, PyObject *key);
+PyObject *zs_persistent_map_set(PyObject *map, PyObject *key, PyObject *value);
+/// @note \a map itself (a new reference) if \a key is missing
+PyObject *zs_persistent_map_remove(PyObject *map, PyObject *key);
+/// @brief a list of (key, value) tuples
+PyObject *zs_persistent_map_items(PyObject *map);
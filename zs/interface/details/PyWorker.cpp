@@ -0,0 +1,210 @@
+#include "PyWorker.hpp"
+
+#include <Python.h>
+
+#include <chrono>
+
+#include "PyHelper.hpp"
+
+ZsJobHandle PyWorker::submit(Task task, zs_job_callback_t callback, void *userData) {
+  auto job = std::make_shared<Job>();
+  job->task = std::move(task);
+  job->callback = callback;
+  job->userData = userData;
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_stopping) return 0;
+    job->handle = _nextHandle++;
+    _jobs.emplace(job->handle, job);
+    _queue.push_back(job);
+    if (!_thread.joinable()) _thread = std::thread{[this]() { run(); }};
+  }
+  _pendingCv.notify_one();
+  return job->handle;
+}
+
+std::shared_ptr<PyWorker::Job> PyWorker::find(ZsJobHandle job) {
+  if (auto it = _jobs.find(job); it != _jobs.end()) return it->second;
+  return nullptr;
+}
+
+zs_job_status_ PyWorker::status(ZsJobHandle job) {
+  std::lock_guard<std::mutex> lk{_mutex};
+  if (auto j = find(job)) return j->status;
+  return zs_job_status_invalid;
+}
+
+zs_job_status_ PyWorker::wait(ZsJobHandle job, long long timeoutMs) {
+  std::unique_lock<std::mutex> lk{_mutex};
+  auto j = find(job);
+  if (!j) return zs_job_status_invalid;
+  auto done = [&j]() {
+    return j->status == zs_job_status_finished || j->status == zs_job_status_cancelled;
+  };
+  if (timeoutMs < 0)
+    _finishedCv.wait(lk, done);
+  else
+    _finishedCv.wait_for(lk, std::chrono::milliseconds(timeoutMs), done);
+  return j->status;
+}
+
+bool PyWorker::cancel(ZsJobHandle job) {
+  std::shared_ptr<Job> cancelled;
+  {
+    /// @note hold the GIL first, so that the running job can not leave python meanwhile
+    GILGuard gilGuard;
+    std::lock_guard<std::mutex> lk{_mutex};
+    auto j = find(job);
+    if (!j) return false;
+    if (j->status == zs_job_status_queued) {
+      for (auto it = _queue.begin(); it != _queue.end(); ++it)
+        if (*it == j) {
+          _queue.erase(it);
+          break;
+        }
+      j->status = zs_job_status_cancelled;
+      cancelled = j;
+    } else if (j->status == zs_job_status_running) {
+      /// @note past its task the job can no longer be interrupted, nor may the exception leak
+      /// into the next job on this (persistent) thread state
+      if (!_executing) return false;
+      j->cancelRequested = true;
+      PyThreadState_SetAsyncExc(_threadIdent, PyExc_KeyboardInterrupt);
+      return true;
+    } else
+      return false;
+  }
+  _finishedCv.notify_all();
+  finish(*cancelled);
+  return true;
+}
+
+void *PyWorker::take(ZsJobHandle job, int *state, void **errLogBytes) {
+  std::lock_guard<std::mutex> lk{_mutex};
+  if (errLogBytes) *errLogBytes = nullptr;
+  auto j = find(job);
+  if (!j || j->status != zs_job_status_finished) {
+    if (state) *state = -1;
+    return nullptr;
+  }
+  if (state) *state = j->state;
+  if (errLogBytes) {
+    *errLogBytes = j->errLogBytes;
+    j->errLogBytes = nullptr;
+  }
+  auto ret = j->result;
+  j->result = nullptr;
+  return ret;
+}
+
+void PyWorker::release(ZsJobHandle job) {
+  std::shared_ptr<Job> j;
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    j = find(job);
+    if (!j) return;
+    if (j->status == zs_job_status_queued || j->status == zs_job_status_running) {
+      /// keep the record until it is done, its results are dropped by the worker
+      j->callback = nullptr;
+    }
+    _jobs.erase(job);
+  }
+  if (j->result || j->errLogBytes) {
+    GILGuard gilGuard;
+    Py_XDECREF(static_cast<PyObject *>(j->result));
+    Py_XDECREF(static_cast<PyObject *>(j->errLogBytes));
+    j->result = j->errLogBytes = nullptr;
+  }
+}
+
+void PyWorker::finish(Job &job) {
+  if (job.callback) job.callback(job.handle, job.userData);
+}
+
+void PyWorker::run() {
+  /// @note jobs reuse one thread state instead of creating one per GIL acquisition
+  zs_register_worker_thread();
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    _threadIdent = PyThread_get_thread_ident();
+  }
+  for (;;) {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lk{_mutex};
+      _pendingCv.wait(lk, [this]() { return _stopping || !_queue.empty(); });
+      if (_queue.empty()) break;  // stopping
+      job = _queue.front();
+      _queue.pop_front();
+      job->status = zs_job_status_running;
+      _current = job;
+    }
+
+    int state = -1;
+    void *errLogBytes = nullptr;
+    {
+      /// @note cancel() raises only while _executing is set, both sides hold the GIL
+      GILGuard gilGuard;
+      std::lock_guard<std::mutex> lk{_mutex};
+      _executing = true;
+    }
+    void *result = job->task(&state, &errLogBytes);
+    {
+      GILGuard gilGuard;
+      std::lock_guard<std::mutex> lk{_mutex};
+      _executing = false;
+      /// drop an interruption requested too late to be delivered
+      PyThreadState_SetAsyncExc(_threadIdent, NULL);
+    }
+
+    bool dropResult = false;
+    {
+      std::lock_guard<std::mutex> lk{_mutex};
+      _current.reset();
+      job->state = state;
+      job->result = result;
+      job->errLogBytes = errLogBytes;
+      /// a job that completed anyway is not reported as cancelled
+      job->status = job->cancelRequested && state != 0 ? zs_job_status_cancelled
+                                                       : zs_job_status_finished;
+      /// released while running, nobody is going to take the results
+      dropResult = _jobs.find(job->handle) == _jobs.end();
+    }
+    if (dropResult && (result || errLogBytes)) {
+      GILGuard gilGuard;
+      Py_XDECREF(static_cast<PyObject *>(result));
+      Py_XDECREF(static_cast<PyObject *>(errLogBytes));
+      job->result = job->errLogBytes = nullptr;
+    }
+    _finishedCv.notify_all();
+    finish(*job);
+  }
+  zs_unregister_worker_thread();
+}
+
+void PyWorker::stop() {
+  std::deque<std::shared_ptr<Job>> pending;
+  {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_stopping || !_thread.joinable()) {
+      _stopping = true;
+      return;
+    }
+    _stopping = true;
+    pending.swap(_queue);
+    for (auto &job : pending) job->status = zs_job_status_cancelled;
+  }
+  {
+    /// @note same lock order as cancel(), GIL first
+    GILGuard gilGuard;
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_current && _executing) {
+      _current->cancelRequested = true;
+      PyThreadState_SetAsyncExc(_threadIdent, PyExc_KeyboardInterrupt);
+    }
+  }
+  _pendingCv.notify_all();
+  _finishedCv.notify_all();
+  for (auto &job : pending) finish(*job);
+  _thread.join();
+}
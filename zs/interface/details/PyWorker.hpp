@@ -0,0 +1,69 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "interface/world/value_type/ValueInterface.hpp"
+
+/**
+ *  @brief Dedicated interpreter thread running submitted python jobs one after another
+ *  The thread is started on the first submission. Jobs acquire the GIL themselves.
+ *  @note Developer should never touch this class.
+ */
+struct PyWorker {
+  /// @brief the job body, returns what the corresponding synchronous C api returns
+  using Task = std::function<void *(int *state, void **errLogBytes)>;
+
+  PyWorker() = default;
+  ~PyWorker() { stop(); }
+  PyWorker(const PyWorker &) = delete;
+  PyWorker &operator=(const PyWorker &) = delete;
+
+  ZsJobHandle submit(Task task, zs_job_callback_t callback, void *userData);
+  zs_job_status_ status(ZsJobHandle job);
+  /// @param timeoutMs negative means wait indefinitely
+  zs_job_status_ wait(ZsJobHandle job, long long timeoutMs);
+  /// @note a running job is interrupted by raising KeyboardInterrupt in it, the GIL is acquired.
+  /// False once its task has returned.
+  bool cancel(ZsJobHandle job);
+  /// @brief transfer the result of a finished job to the caller
+  void *take(ZsJobHandle job, int *state, void **errLogBytes);
+  /// @note drops results not taken yet, the GIL is acquired if necessary. A queued or running
+  /// job is not cancelled, its results are dropped once done.
+  void release(ZsJobHandle job);
+  /// @brief cancel all pending jobs, interrupt the running one and join the thread
+  void stop();
+
+private:
+  struct Job {
+    ZsJobHandle handle;
+    Task task;
+    zs_job_callback_t callback;
+    void *userData;
+    zs_job_status_ status = zs_job_status_queued;
+    bool cancelRequested = false;
+    int state = -1;
+    void *result = nullptr;
+    void *errLogBytes = nullptr;
+  };
+  void run();
+  static void finish(Job &job);
+  std::shared_ptr<Job> find(ZsJobHandle job);
+
+  std::mutex _mutex;
+  std::condition_variable _pendingCv;   // worker waits for jobs
+  std::condition_variable _finishedCv;  // callers wait for completion
+  std::deque<std::shared_ptr<Job>> _queue;
+  std::unordered_map<ZsJobHandle, std::shared_ptr<Job>> _jobs;
+  std::shared_ptr<Job> _current;
+  /// the current job is inside its task, written with both the GIL and _mutex held
+  bool _executing = false;
+  std::thread _thread;
+  unsigned long _threadIdent = 0;
+  ZsJobHandle _nextHandle = 1;
+  bool _stopping = false;
+};
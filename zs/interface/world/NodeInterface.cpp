@@ -3,65 +3,48 @@
 
 namespace zs {
 
+static ZsKey g_descKeys[] = {"type", "name", "defl", "doc"};
+static ZsKey g_uiDescKeys[] = {"inputs", "outputs", "attribs", "category"};
+
+/// @brief {type, name, defl, doc} of a socket/attrib descriptor, empty fields are skipped
+template <typename Desc> static ZsValuePort build_item_desc(const Desc &desc) {
+  auto field = [](const char *item) {
+    return item && item[0] != '\0' ? ZsValue{zs_bytes_obj_cstr(item)} : ZsValue{};
+  };
+  ZsValue values[] = {field(desc.type), field(desc.name), field(desc.defl), field(desc.doc)};
+  return zs_dict_obj_from_keys(g_descKeys, values, 4);
+}
+template <typename Desc> static ZsValuePort build_item_descs(const Desc *descs, unsigned num) {
+  ZsList list = zs_list_obj_sized(num);
+  for (unsigned i = 0; i < num; ++i) list.setItemSteal(i, build_item_desc(descs[i]));
+  return list;
+}
+
 ZsValuePort zs_build_node_ui_desc(NodeDescriptorPort desc) {
-  ZsDict dict = zs_dict_obj_default();
-  auto setDictItem = [](ZsDict dict, const char *tag, const char *item) {
-    if (item && item[0] != '\0') {
-      dict.setSteal(tag, zs_bytes_obj_cstr(item));
-    }
+  ZsValue lists[4] = {
+      ZsValue{build_item_descs(desc._inputDescriptors, desc._numInputs)},
+      ZsValue{build_item_descs(desc._outputDescriptors, desc._numOutputs)},
+      ZsValue{build_item_descs(desc._attribDescriptors, desc._numAttribs)},
   };
-  // inputs
-  ZsList inputList = zs_list_obj_default();
-  for (unsigned i = 0; i < desc._numInputs; ++i) {
-    ZsDict dictItem = zs_dict_obj_default();
-    const auto &socketDesc = desc._inputDescriptors[i];
-    setDictItem(dictItem, "type", socketDesc.type);
-    setDictItem(dictItem, "name", socketDesc.name);
-    setDictItem(dictItem, "defl", socketDesc.defl);
-    setDictItem(dictItem, "doc", socketDesc.doc);
-    inputList.appendSteal(dictItem);
-  }
-  // outputs
-  ZsList outputList = zs_list_obj_default();
-  for (unsigned i = 0; i < desc._numOutputs; ++i) {
-    ZsDict dictItem = zs_dict_obj_default();
-    const auto &socketDesc = desc._outputDescriptors[i];
-    setDictItem(dictItem, "type", socketDesc.type);
-    setDictItem(dictItem, "name", socketDesc.name);
-    setDictItem(dictItem, "defl", socketDesc.defl);
-    setDictItem(dictItem, "doc", socketDesc.doc);
-    outputList.appendSteal(dictItem);
-  }
-  // attribs
-  ZsList attribList = zs_list_obj_default();
-  for (unsigned i = 0; i < desc._numAttribs; ++i) {
-    ZsDict dictItem = zs_dict_obj_default();
-    const auto &attribDesc = desc._attribDescriptors[i];
-    setDictItem(dictItem, "type", attribDesc.type);
-    setDictItem(dictItem, "name", attribDesc.name);
-    setDictItem(dictItem, "defl", attribDesc.defl);
-    setDictItem(dictItem, "doc", attribDesc.doc);
-    attribList.appendSteal(dictItem);
-  }
   // category
-  ZsList categoryList = zs_list_obj_default();
   const char *st = desc._categoryDescriptor.category;
   const char *ed = st;
+  sint_t numSegments = 0;
   if (ed) {
-    while (*ed != '\0') ed++;
+    for (numSegments = 1; *ed != '\0'; ed++) numSegments += *ed == '.' || *ed == '/';
+  }
+  ZsList categoryList = zs_list_obj_sized(numSegments);
+  if (st) {
     const char *it = st;
-    while (it != ed + 1) {
+    for (sint_t i = 0; it != ed + 1; ++i) {
       // [st, it)
       while (*it != '\0' && *it != '.' && *it != '/') it++;
-      categoryList.appendSteal(zs_bytes_obj_cstr_range(st, it - st));
+      categoryList.setItemSteal(i, zs_bytes_obj_cstr_range(st, it - st));
       st = ++it;
     }
   }
-  dict.setSteal("inputs", inputList);
-  dict.setSteal("outputs", outputList);
-  dict.setSteal("attribs", attribList);
-  dict.setSteal("category", categoryList);
-  return dict;
+  lists[3] = categoryList;
+  return zs_dict_obj_from_keys(g_uiDescKeys, lists, 4);
 }
 
 }
\ No newline at end of file
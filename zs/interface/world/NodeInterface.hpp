@@ -32,6 +32,8 @@ namespace zs {
     virtual ZsValue getOutput(const char *tag) { return nullptr; }
 
     virtual ResultType preApply() { return Result::Success; }
+    /// @note wrap heavy native work in a GILRelease scope, so that python may run meanwhile
+    /// (or see zs::parallel_for_items for per-item work over python containers)
     virtual ResultType apply() = 0;
     virtual ResultType postApply() { return Result::Success; }
 
@@ -0,0 +1,131 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+#include "interface/details/PyHelper.hpp"
+#include "value_type/ValueInterface.hpp"
+
+namespace zs {
+
+  /// @brief options of parallel_for_items
+  struct ParallelItemsConfig {
+    /// number of consecutive items processed by one task
+    sint_t chunkSize = 256;
+    /// number of threads used, 0 for the OpenMP default (or the hardware concurrency)
+    int numThreads = 0;
+  };
+
+  namespace detail {
+    /// @brief run f(chunk) for every chunk in [0, numChunks), on the OpenMP backend if enabled,
+    /// otherwise on a pool of threads taking chunks from a shared counter
+    template <typename F> void parallel_for_chunks(sint_t numChunks, int numThreads, F &&f) {
+      if (numChunks <= 0) return;
+#ifdef _OPENMP
+      const int nt = numThreads > 0 ? numThreads : omp_get_max_threads();
+#  pragma omp parallel for schedule(dynamic, 1) num_threads(nt)
+      for (sint_t c = 0; c < numChunks; ++c) f(c);
+#else
+      sint_t nt = numThreads > 0 ? numThreads : (sint_t)std::thread::hardware_concurrency();
+      nt = std::max<sint_t>(1, std::min<sint_t>(nt, numChunks));
+      std::atomic<sint_t> next{0};
+      auto worker = [&]() {
+        for (sint_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < numChunks;) f(c);
+      };
+      std::vector<std::thread> threads;
+      threads.reserve(nt - 1);
+      for (sint_t i = 1; i < nt; ++i) threads.emplace_back(worker);
+      worker();
+      for (auto &t : threads) t.join();
+#endif
+    }
+  }  // namespace detail
+
+  /**
+    @brief process the items of a python iterable (e.g. a ZsList of records) in parallel, in three
+    phases:
+    (1) \a extract a native payload from every item, with the GIL held,
+    (2) release the GIL and \a process the payloads chunk by chunk in parallel,
+    (3) reacquire the GIL once and \a writeBack every result, in item order.
+    \code
+zs::parallel_for_items(
+    list, [](ZsObject item) { return extract_mesh(item); },  // Payload(ZsObject)
+    [](Mesh &mesh, sint_t i) { return remesh(mesh); },       // Result(Payload &, sint_t)
+    [&](sint_t i, Mesh &&mesh) { out.appendSteal(to_py(mesh)); });  // void(sint_t, Result &&)
+    \endcode
+    @return the number of items processed, -1 if \a items could not be iterated
+    @note the caller must hold the GIL. \a process must not touch python objects, and its result
+    type must be default-constructible, or void in which case \a writeBack is void(sint_t). An
+    exception thrown by \a process stops the remaining chunks, and is rethrown once the GIL is
+    reacquired, in which case nothing is written back.
+   */
+  template <typename Extract, typename Process, typename WriteBack>
+  sint_t parallel_for_items(ZsValue items, Extract &&extract, Process &&process,
+                            WriteBack &&writeBack, const ParallelItemsConfig &config = {}) {
+    using Payload = std::decay_t<std::invoke_result_t<Extract &, ZsObject>>;
+    using Result = std::decay_t<std::invoke_result_t<Process &, Payload &, sint_t>>;
+
+    // (1) extract, GIL held
+    std::vector<Payload> payloads;
+    {
+      ZsChunkIterator it{items};
+      if (!it) return -1;
+      ZsObject chunk[256];
+      sint_t n;
+      while ((n = it.next(chunk, 256)) > 0)
+        for (sint_t i = 0; i < n; ++i) payloads.push_back(extract(chunk[i]));
+      if (n < 0) return -1;
+    }
+
+    // (2) process, GIL released
+    const sint_t numItems = payloads.size();
+    const sint_t chunkSize = config.chunkSize > 0 ? config.chunkSize : 1;
+    /// @note a plain array, std::vector<bool> would pack the results of neighbouring chunks into
+    /// the same word
+    constexpr bool hasResult = !std::is_void_v<Result>;
+    using Storage = std::conditional_t<hasResult, Result, char>;
+    std::unique_ptr<Storage[]> results{hasResult ? new Storage[numItems] : nullptr};
+    std::exception_ptr error;
+    {
+      GILRelease release;
+      std::atomic<bool> failed{false};
+      std::mutex errorLock;
+      detail::parallel_for_chunks(
+          (numItems + chunkSize - 1) / chunkSize, config.numThreads, [&](sint_t c) {
+            if (failed.load(std::memory_order_relaxed)) return;
+            try {
+              const sint_t ed = std::min(numItems, (c + 1) * chunkSize);
+              for (sint_t i = c * chunkSize; i < ed; ++i) {
+                if constexpr (hasResult)
+                  results[i] = process(payloads[i], i);
+                else
+                  process(payloads[i], i);
+              }
+            } catch (...) {
+              std::lock_guard<std::mutex> lk{errorLock};
+              if (!failed.exchange(true)) error = std::current_exception();
+            }
+          });
+    }
+    if (error) std::rethrow_exception(error);
+
+    // (3) write back, GIL held
+    for (sint_t i = 0; i < numItems; ++i) {
+      if constexpr (hasResult)
+        writeBack(i, std::move(results[i]));
+      else
+        writeBack(i);
+    }
+    return numItems;
+  }
+
+}  // namespace zs
@@ -1,6 +1,8 @@
 #include "ValueInterface.hpp"
 #include "interface/details/Py.hpp"
 #include "interface/details/PyHelper.hpp"
+#include "interface/details/PyNumeric.hpp"
+#include "interface/details/PyPersistent.hpp"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +28,7 @@ ZsValuePort zs_bool_obj(bool b) {
 /// module
 ///
 ZsValuePort zs_module_cstr(const char *name) {
+  zs_ensure_initialized();
   if (!name) return zs_obj(Py_None);
   if (auto ret = PyModule_New(name)) return zs_obj(ret);
   return zs_obj(Py_None);
@@ -35,11 +38,13 @@ ZsValuePort zs_module_cstr(const char *name) {
 /// bytes
 ///
 ZsValuePort zs_bytes_obj_cstr(const char *cstr) {
+  zs_ensure_initialized();
   if (!cstr) return zs_obj(Py_None);
   if (auto ret = PyBytes_FromString(cstr)) return zs_obj(ret);
   return zs_obj(Py_None);
 }
 ZsValuePort zs_bytes_obj_cstr_range(const char *st, sint_t len) {
+  zs_ensure_initialized();
   if (auto ret = PyBytes_FromStringAndSize(st, len)) return zs_obj(ret);
   return zs_obj(Py_None);
 }
@@ -54,7 +59,7 @@ ZsValuePort zs_bytes_obj(ZsValue args) {
       if (str) {
         return ZsBytes(str);
       } else {
-        PyErr_Print();
+        zs_report_error();
       }
     } else if (tp == &PyByteArray_Type) {
       Py_INCREF(args._v.obj);
@@ -72,6 +77,7 @@ ZsValuePort zs_bytes_obj(ZsValue args) {
 /// bytearray
 ///
 ZsValuePort zs_bytearray_obj_cstr_range(const char *st, sint_t len) {
+  zs_ensure_initialized();
   if (auto ret = PyByteArray_FromStringAndSize(st, len)) return zs_obj(ret);
   return zs_obj(Py_None);
 }
@@ -79,6 +85,155 @@ ZsValuePort zs_bytearray_obj_cstr(const char *str) {
   return zs_bytearray_obj_cstr_range(str, strlen(str));
 }
 
+///
+/// external buffer
+///
+struct ZsExternalBufferObject {
+  PyObject_HEAD
+  void *data;
+  Py_ssize_t len;
+  Py_ssize_t itemsize;
+  int ndim;
+  int readonly;
+  bool cContiguous;
+  bool fContiguous;
+  char *format;
+  Py_ssize_t *shape;  // followed by strides, one allocation
+  Py_ssize_t *strides;
+  zs_buffer_release_t release;
+  void *userData;
+};
+
+static int zs_external_buffer_get(PyObject *self, Py_buffer *view, int flags) {
+  auto buf = reinterpret_cast<ZsExternalBufferObject *>(self);
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE && buf->readonly) {
+    PyErr_SetString(PyExc_BufferError, "external buffer is read-only");
+    return -1;
+  }
+  /// @note consumers not dealing with strides expect C-contiguous memory
+  bool contiguous;
+  if ((flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS)
+    contiguous = buf->cContiguous;
+  else if ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS)
+    contiguous = buf->fContiguous;
+  else if ((flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS)
+    contiguous = buf->cContiguous || buf->fContiguous;
+  else if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+    contiguous = true;
+  else
+    contiguous = buf->cContiguous;
+  if (!contiguous) {
+    PyErr_SetString(PyExc_BufferError, "external buffer is not contiguous as requested");
+    return -1;
+  }
+  view->obj = Py_NewRef(self);
+  view->buf = buf->data;
+  view->len = buf->len;
+  view->itemsize = buf->itemsize;
+  view->readonly = buf->readonly;
+  view->ndim = buf->ndim;
+  view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? buf->format : NULL;
+  view->shape = (flags & PyBUF_ND) == PyBUF_ND ? buf->shape : NULL;
+  view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? buf->strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  if (!view->shape) view->ndim = 1;  // consumer asked for plain bytes
+  return 0;
+}
+static void zs_external_buffer_dealloc(PyObject *self) {
+  auto buf = reinterpret_cast<ZsExternalBufferObject *>(self);
+  /// @note every export holds a reference, nothing refers to the memory any more
+  if (buf->release) buf->release(buf->data, buf->userData);
+  PyMem_Free(buf->format);
+  PyMem_Free(buf->shape);
+  PyTypeObject *tp = Py_TYPE(self);
+  PyObject_Free(self);
+  Py_DECREF(tp);
+}
+static PyObject *zs_external_buffer_nbytes(PyObject *self, void *) {
+  return PyLong_FromSsize_t(reinterpret_cast<ZsExternalBufferObject *>(self)->len);
+}
+
+static PyGetSetDef g_zs_external_buffer_getset[] = {
+    {"nbytes", zs_external_buffer_nbytes, NULL, NULL, NULL},
+    {NULL, NULL, NULL, NULL, NULL},
+};
+static PyType_Slot g_zs_external_buffer_slots[] = {
+    {Py_tp_dealloc, (void *)zs_external_buffer_dealloc},
+    {Py_tp_getset, g_zs_external_buffer_getset},
+    {Py_bf_getbuffer, (void *)zs_external_buffer_get},
+    {0, NULL},
+};
+static PyType_Spec g_zs_external_buffer_spec = {
+    "zs.ExternalBuffer",
+    sizeof(ZsExternalBufferObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    g_zs_external_buffer_slots,
+};
+static PyObject *g_zs_external_buffer_type = NULL;
+
+ZsValuePort zs_buffer_obj_external(void *data, const char *format, sint_t itemsize, int ndim,
+                                   const sint_t *shape, const sint_t *strides, bool readonly,
+                                   zs_buffer_release_t release, void *userData) {
+  if (!format) format = "B";
+  if (itemsize <= 0 || ndim < 0 || ndim > PyBUF_MAX_NDIM || (ndim && !shape)) return zs_obj(Py_None);
+  if (!g_zs_external_buffer_type) {
+    g_zs_external_buffer_type = PyType_FromSpec(&g_zs_external_buffer_spec);
+    if (!g_zs_external_buffer_type) {
+      zs_report_error();
+      return zs_obj(Py_None);
+    }
+  }
+  auto ret = PyObject_New(ZsExternalBufferObject, (PyTypeObject *)g_zs_external_buffer_type);
+  if (!ret) {
+    zs_report_error();
+    return zs_obj(Py_None);
+  }
+  ret->data = data;
+  ret->itemsize = itemsize;
+  ret->ndim = ndim;
+  ret->readonly = readonly;
+  ret->release = NULL;  // not owned until fully set up
+  ret->userData = userData;
+  auto formatLen = strlen(format);
+  ret->format = static_cast<char *>(PyMem_Malloc(formatLen + 1));
+  /// @note one extra slot each, so that a scalar (ndim 0) still has a valid allocation
+  ret->shape = PyMem_New(Py_ssize_t, 2 * (ndim + 1));
+  if (!ret->format || !ret->shape) {
+    Py_DECREF(ret);
+    return zs_obj(Py_None);
+  }
+  memcpy(ret->format, format, formatLen + 1);
+  ret->strides = ret->shape + ndim + 1;
+  Py_ssize_t len = itemsize;
+  for (int d = 0; d != ndim; ++d) {
+    if (shape[d] < 0) {
+      Py_DECREF(ret);
+      return zs_obj(Py_None);
+    }
+    ret->shape[d] = shape[d];
+    len *= shape[d];
+  }
+  Py_ssize_t stride = itemsize;
+  for (int d = ndim - 1; d >= 0; --d) {
+    ret->strides[d] = strides ? strides[d] : stride;
+    stride *= shape[d];
+  }
+  ret->len = len;
+  Py_buffer probe{};
+  probe.buf = data;
+  probe.len = len;
+  probe.itemsize = itemsize;
+  probe.ndim = ndim;
+  probe.shape = ret->shape;
+  probe.strides = ret->strides;
+  ret->cContiguous = PyBuffer_IsContiguous(&probe, 'C');
+  ret->fContiguous = PyBuffer_IsContiguous(&probe, 'F');
+  ret->release = release;
+  return zs_obj(ret);
+}
+
 ///
 /// string
 ///
@@ -106,14 +261,17 @@ ZsValuePort zs_string_obj(ZsValue obj) {
   return zs_obj(Py_None);
 }
 ZsValuePort zs_string_obj_long_long(long long n) {
+  zs_ensure_initialized();
   if (auto ret = PyUnicode_FromFormat("%lld", n)) return zs_obj(ret);
   return zs_obj(Py_None);
 }
 ZsValuePort zs_string_obj_double(double f) {
+  zs_ensure_initialized();
   if (auto ret = PyUnicode_FromFormat("%f", f)) return zs_obj(ret);
   return zs_obj(Py_None);
 }
 ZsValuePort zs_string_obj_cstr(const char *cstr) {
+  zs_ensure_initialized();
   if (!cstr) return zs_obj(Py_None);
   if (auto ret = PyUnicode_FromString(cstr)) return zs_obj(ret);
   return zs_obj(Py_None);
@@ -172,32 +330,39 @@ ZsValuePort zs_string_obj_type(ZsValue obj) {
 ///
 // floating point
 ZsValuePort zs_float_obj_double(double f) {
+  zs_ensure_initialized();
   if (auto ret = PyFloat_FromDouble(f)) return zs_obj(ret);
+  zs_report_error();
   return zs_obj(Py_None);
 }
 ZsValuePort zs_float_obj_str(ZsValue str) {
   if (str._idx == zs_var_type_cstr) {
     auto pystr = zs_string_obj_cstr(str._v.cstr);
-    if (auto ret = PyFloat_FromString(as_ptr_<PyObject>(pystr._v.obj))) {
-      Py_DECREF(pystr._v.obj);
-      return zs_obj(ret);
-    }
+    auto ret = PyFloat_FromString(as_ptr_<PyObject>(pystr._v.obj));
+    Py_DECREF(pystr._v.obj);
+    if (ret) return zs_obj(ret);
   } else if (auto ret = PyFloat_FromString(as_ptr_<PyObject>(str)))
     return zs_obj(ret);
+  zs_report_error();
   return zs_obj(Py_None);
 }
 // integral
 ZsValuePort zs_long_obj_double(double f) {
+  zs_ensure_initialized();
   if (auto ret = PyLong_FromDouble(f)) return zs_obj(ret);
+  zs_report_error();
   return zs_obj(Py_None);
 }
 ZsValuePort zs_long_obj_long_long(long long n) {
+  zs_ensure_initialized();
   if (auto ret = PyLong_FromLongLong(n)) return zs_obj(ret);
+  zs_report_error();
   return zs_obj(Py_None);
 }
 ZsValuePort zs_long_obj_str(ZsValue str) {
   if (str._idx == zs_var_type_cstr) {
     if (auto ret = PyLong_FromString(str._v.cstr, NULL, 0)) return zs_obj(ret);
+    zs_report_error();
   } else {
     ZsBytes pystr = zs_bytes_obj(str);
     if (pystr) {
@@ -205,7 +370,7 @@ ZsValuePort zs_long_obj_str(ZsValue str) {
         Py_DECREF(static_cast<void *>(pystr));
         return zs_obj(ret);
       } else {
-        PyErr_Print();
+        zs_report_error();
       }
       Py_DECREF(static_cast<void *>(pystr));
     }
@@ -261,11 +426,12 @@ ZsValuePort zs_tuple_obj_pack_zsobjs(sint_t count, ...) {
   return zs_obj(Py_None);
 }
 ZsValuePort zs_tuple_obj_default(long len) {
+  zs_ensure_initialized();
   ZsTuple ret;
   if ((ret._v.obj = PyTuple_New(len))) {
     for (int i = 0; i < len; ++i)
       if (PyTuple_SetItem(static_cast<PyObject *>(ret._v.obj), i, PyLong_FromLong(-1)) == -1) {
-        PyErr_Print();
+        zs_report_error();
         Py_DECREF(ret.handle());
         return zs_obj(Py_None);
       }
@@ -275,10 +441,11 @@ ZsValuePort zs_tuple_obj_default(long len) {
   return zs_obj(Py_None);
 }
 ZsValuePort zs_tuple_obj_long(long n) {
+  zs_ensure_initialized();
   ZsTuple ret;
   if ((ret._v.obj = PyTuple_New(1))) {
     if (PyTuple_SetItem(static_cast<PyObject *>(ret._v.obj), 0, PyLong_FromLong(n)) == -1) {
-      PyErr_Print();
+      zs_report_error();
       Py_DECREF(ret.handle());
       return zs_obj(Py_None);
     }
@@ -288,10 +455,44 @@ ZsValuePort zs_tuple_obj_long(long n) {
   return zs_obj(Py_None);
 }
 
+/// @brief the stolen reference of \a item, a new reference to Py_None if it is empty
+/// @note nullptr (with the python error set) if \a item is not a python object
+static PyObject *zs_stolen_item(const ZsValue &item) {
+  if (item._idx == zs_var_type_none) return Py_NewRef(Py_None);
+  if (item._idx == zs_var_type_object && item._v.obj) return static_cast<PyObject *>(item._v.obj);
+  PyErr_SetString(PyExc_TypeError, "only python objects can be stolen into a container");
+  return nullptr;
+}
+static void zs_release_items(const ZsValue *items, sint_t count) {
+  for (sint_t i = 0; i < count; ++i)
+    if (items[i]._idx == zs_var_type_object) Py_XDECREF(static_cast<PyObject *>(items[i]._v.obj));
+}
+ZsValuePort zs_tuple_obj_sized(sint_t len) {
+  zs_ensure_initialized();
+  if (auto tup = PyTuple_New(len)) return zs_obj(tup);
+  zs_report_error();
+  return zs_obj(Py_None);
+}
+ZsValuePort zs_tuple_obj_steal(const ZsValue *items, sint_t count) {
+  PyObject *tup = PyTuple_New(count);
+  sint_t i = 0;
+  for (; tup && i < count; ++i) {
+    if (PyObject *item = zs_stolen_item(items[i]))
+      PyTuple_SET_ITEM(tup, i, item);
+    else
+      Py_CLEAR(tup);
+  }
+  if (tup) return zs_obj(tup);
+  zs_release_items(items + i, count - i);
+  zs_report_error();
+  return zs_obj(Py_None);
+}
+
 ///
 /// dict
 ///
 ZsValuePort zs_dict_obj_default() {
+  zs_ensure_initialized();
   ZsDict ret;
   if ((ret._v.obj = PyDict_New())) {
     ret._idx = zs_var_type_object;
@@ -299,10 +500,26 @@ ZsValuePort zs_dict_obj_default() {
   }
   return zs_obj(Py_None);
 }
+ZsValuePort zs_dict_obj_from_keys(const ZsKey *keys, const ZsValue *values, sint_t count) {
+  zs_ensure_initialized();
+  PyObject *dict = PyDict_New();
+  sint_t i = 0;
+  for (; dict && i < count; ++i) {
+    if (values[i]._idx == zs_var_type_none) continue;
+    auto key = static_cast<PyObject *>(keys[i].handle());
+    PyObject *value = zs_stolen_item(values[i]);
+    if (!key || !value || PyDict_SetItem(dict, key, value) == -1) Py_CLEAR(dict);
+    Py_XDECREF(value);
+  }
+  if (dict) return zs_obj(dict);
+  zs_release_items(values + i, count - i);
+  if (PyErr_Occurred()) zs_report_error();
+  return zs_obj(Py_None);
+}
 ZsValuePort zs_dict_obj_copy(ZsDict dict) {
   ZsDict ret;
   if ((ret._v.obj = PyDict_Copy(as_ptr_<PyObject>(dict)))) return ret;
-  PyErr_Print();
+  zs_report_error();
   return zs_obj(Py_None);
 }
 
@@ -310,6 +527,7 @@ ZsValuePort zs_dict_obj_copy(ZsDict dict) {
 /// list
 ///
 ZsValuePort zs_list_obj_default() {
+  zs_ensure_initialized();
   ZsList ret;
   if ((ret._v.obj = PyList_New(0))) {
     ret._idx = zs_var_type_object;
@@ -318,10 +536,69 @@ ZsValuePort zs_list_obj_default() {
   return zs_obj(Py_None);
 }
 
+ZsValuePort zs_list_obj_sized(sint_t len) {
+  zs_ensure_initialized();
+  if (auto list = PyList_New(len)) return zs_obj(list);
+  zs_report_error();
+  return zs_obj(Py_None);
+}
+ZsValuePort zs_list_obj_steal(const ZsValue *items, sint_t count) {
+  PyObject *list = PyList_New(count);
+  sint_t i = 0;
+  for (; list && i < count; ++i) {
+    if (PyObject *item = zs_stolen_item(items[i]))
+      PyList_SET_ITEM(list, i, item);
+    else
+      Py_CLEAR(list);
+  }
+  if (list) return zs_obj(list);
+  zs_release_items(items + i, count - i);
+  zs_report_error();
+  return zs_obj(Py_None);
+}
+
+///
+/// bulk numeric conversion
+///
+#define ZS_NUMERIC_BUILDERS(SUFFIX, TYPE)                                              \
+  ZsValuePort zs_list_obj_from_##SUFFIX(const TYPE *src, sint_t count) {              \
+    ZsList ret;                                                                       \
+    if ((ret._v.obj = zs_numeric_to_sequence(src, (Py_ssize_t)count, false))) {       \
+      ret._idx = zs_var_type_object;                                                  \
+      return ret;                                                                     \
+    }                                                                                 \
+    zs_report_error();                                                                \
+    return zs_obj(Py_None);                                                           \
+  }                                                                                   \
+  ZsValuePort zs_tuple_obj_from_##SUFFIX(const TYPE *src, sint_t count) {             \
+    ZsTuple ret;                                                                      \
+    if ((ret._v.obj = zs_numeric_to_sequence(src, (Py_ssize_t)count, true))) {        \
+      ret._idx = zs_var_type_object;                                                  \
+      return ret;                                                                     \
+    }                                                                                 \
+    zs_report_error();                                                                \
+    return zs_obj(Py_None);                                                           \
+  }                                                                                   \
+  sint_t zs_sequence_to_##SUFFIX(ZsValue seq, TYPE *dst, sint_t capacity) {           \
+    if (seq._idx != zs_var_type_object || !seq._v.obj || (capacity > 0 && !dst)) {    \
+      return -1;                                                                      \
+    }                                                                                 \
+    auto n = zs_numeric_from_sequence(static_cast<PyObject *>(seq._v.obj), dst,       \
+                                      (Py_ssize_t)capacity);                          \
+    if (n < 0) zs_report_error();                                                     \
+    return n;                                                                         \
+  }
+ZS_NUMERIC_BUILDERS(f64, double)
+ZS_NUMERIC_BUILDERS(f32, float)
+ZS_NUMERIC_BUILDERS(i64, long long)
+ZS_NUMERIC_BUILDERS(i32, int)
+#undef ZS_NUMERIC_BUILDERS
+
 ///
 /// set
 ///
 ZsValuePort zs_set_obj_default() {
+  zs_ensure_initialized();
   ZsSet ret;
   if ((ret._v.obj = PySet_New(NULL))) {
     ret._idx = zs_var_type_object;
@@ -330,6 +607,50 @@ ZsValuePort zs_set_obj_default() {
   return zs_obj(Py_None);
 }
 
+///
+/// persistent list / map
+///
+ZsValuePort zs_plist_obj_default() {
+  zs_ensure_initialized();
+  ZsPList ret;
+  if ((ret._v.obj = zs_persistent_list_new(NULL))) {
+    ret._idx = zs_var_type_object;
+    return ret;
+  }
+  zs_report_error();
+  return zs_obj(Py_None);
+}
+ZsValuePort zs_plist_obj(ZsValue iterable) {
+  if (!iterable.isObject()) return zs_obj(Py_None);
+  ZsPList ret;
+  if ((ret._v.obj = zs_persistent_list_new(as_ptr_<PyObject>(iterable)))) {
+    ret._idx = zs_var_type_object;
+    return ret;
+  }
+  zs_report_error();
+  return zs_obj(Py_None);
+}
+ZsValuePort zs_pmap_obj_default() {
+  zs_ensure_initialized();
+  ZsPMap ret;
+  if ((ret._v.obj = zs_persistent_map_new(NULL))) {
+    ret._idx = zs_var_type_object;
+    return ret;
+  }
+  zs_report_error();
+  return zs_obj(Py_None);
+}
+ZsValuePort zs_pmap_obj(ZsValue mapping) {
+  if (!mapping.isObject()) return zs_obj(Py_None);
+  ZsPMap ret;
+  if ((ret._v.obj = zs_persistent_map_new(as_ptr_<PyObject>(mapping)))) {
+    ret._idx = zs_var_type_object;
+    return ret;
+  }
+  zs_report_error();
+  return zs_obj(Py_None);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -358,13 +679,211 @@ PyVar &PyVar::operator=(const PyVar &o) {
   return *this;
 }
 
+///
+/// buffer view
+///
+ZsBuffer::ZsBuffer(ZsValue obj, bool writable) {
+  if (obj._idx != zs_var_type_object || !obj._v.obj) return;
+  auto view = new Py_buffer;
+  if (PyObject_GetBuffer(static_cast<PyObject *>(obj._v.obj), view,
+                         writable ? PyBUF_RECORDS : PyBUF_RECORDS_RO)
+      == 0) {
+    _view = view;
+  } else {
+    zs_report_error();
+    delete view;
+  }
+}
+ZsBuffer::~ZsBuffer() { release(); }
+ZsBuffer &ZsBuffer::operator=(ZsBuffer &&o) noexcept {
+  if (this != &o) {
+    release();
+    _view = o._view;
+    o._view = nullptr;
+  }
+  return *this;
+}
+void ZsBuffer::release() {
+  if (auto view = static_cast<Py_buffer *>(_view)) {
+    PyBuffer_Release(view);
+    delete view;
+    _view = nullptr;
+  }
+}
+ZsObject ZsBuffer::obj() const {
+  return _view ? ZsObject{static_cast<Py_buffer *>(_view)->obj} : ZsObject{};
+}
+void *ZsBuffer::data() const { return _view ? static_cast<Py_buffer *>(_view)->buf : nullptr; }
+sint_t ZsBuffer::size() const { return _view ? static_cast<Py_buffer *>(_view)->len : 0; }
+sint_t ZsBuffer::itemsize() const {
+  return _view ? static_cast<Py_buffer *>(_view)->itemsize : 0;
+}
+sint_t ZsBuffer::count() const {
+  auto view = static_cast<Py_buffer *>(_view);
+  return view && view->itemsize ? view->len / view->itemsize : 0;
+}
+int ZsBuffer::ndim() const { return _view ? static_cast<Py_buffer *>(_view)->ndim : 0; }
+sint_t ZsBuffer::shape(int dim) const {
+  auto view = static_cast<Py_buffer *>(_view);
+  if (!view || dim < 0 || dim >= view->ndim) return 0;
+  return view->shape ? view->shape[dim] : count();
+}
+sint_t ZsBuffer::stride(int dim) const {
+  auto view = static_cast<Py_buffer *>(_view);
+  if (!view || dim < 0 || dim >= view->ndim) return 0;
+  return view->strides ? view->strides[dim] : view->itemsize;
+}
+const char *ZsBuffer::format() const {
+  if (!_view) return nullptr;
+  auto fmt = static_cast<Py_buffer *>(_view)->format;
+  return fmt ? fmt : "B";
+}
+bool ZsBuffer::readonly() const { return !_view || static_cast<Py_buffer *>(_view)->readonly; }
+bool ZsBuffer::contiguous(char order) const {
+  return _view && PyBuffer_IsContiguous(static_cast<Py_buffer *>(_view), order);
+}
+
+/// chunked iteration
+enum zs_chunk_iter_kind_ : int {
+  zs_chunk_iter_none = 0,
+  zs_chunk_iter_list,
+  zs_chunk_iter_tuple,
+  zs_chunk_iter_dict,
+  zs_chunk_iter_set,
+  zs_chunk_iter_generic
+};
+ZsChunkIterator::ZsChunkIterator(ZsValue iterable) {
+  if (iterable._idx != zs_var_type_object || !iterable._v.obj) return;
+  auto obj = static_cast<PyObject *>(iterable._v.obj);
+  if (PyList_CheckExact(obj))
+    _kind = zs_chunk_iter_list;
+  else if (PyTuple_CheckExact(obj))
+    _kind = zs_chunk_iter_tuple;
+  else if (PyDict_CheckExact(obj)) {
+    _kind = zs_chunk_iter_dict;
+    _size = PyDict_GET_SIZE(obj);
+  } else if (PySet_CheckExact(obj) || PyFrozenSet_CheckExact(obj)) {
+    _kind = zs_chunk_iter_set;
+    _size = PySet_GET_SIZE(obj);
+  } else {
+    if (!(_src = PyObject_GetIter(obj))) zs_report_error();
+    _kind = zs_chunk_iter_generic;
+    return;
+  }
+  _src = Py_NewRef(obj);
+}
+ZsChunkIterator::~ZsChunkIterator() {
+  releaseHeld();
+  PyMem_Free(_held);
+  Py_XDECREF(static_cast<PyObject *>(_src));
+}
+void ZsChunkIterator::releaseHeld() {
+  for (sint_t i = 0; i < _numHeld; ++i) Py_DECREF(static_cast<PyObject *>(_held[i]));
+  _numHeld = 0;
+}
+sint_t ZsChunkIterator::fill(ZsObject *dst, sint_t capacity, bool owned) {
+  releaseHeld();
+  if (!_src || _status < 0) return -1;
+  if (_status > 0 || capacity <= 0) return 0;
+  auto src = static_cast<PyObject *>(_src);
+  sint_t n = 0;
+  switch (_kind) {
+    case zs_chunk_iter_list:
+    case zs_chunk_iter_tuple: {
+      // the list may shrink between calls
+      PyObject **items = PySequence_Fast_ITEMS(src);
+      sint_t size = Py_SIZE(src);
+      for (; n < capacity && _pos < size; ++n, ++_pos) {
+        dst[n]._v.obj = items[_pos];
+        dst[n]._idx = zs_var_type_object;
+        if (owned) Py_INCREF(items[_pos]);
+      }
+      break;
+    }
+    case zs_chunk_iter_dict: {
+      if (PyDict_GET_SIZE(src) != _size) {
+        PyErr_SetString(PyExc_RuntimeError, "dictionary changed size during iteration");
+        zs_report_error();
+        _status = -1;
+        return -1;
+      }
+      Py_ssize_t pos = _pos;
+      PyObject *key;
+      for (; n < capacity && PyDict_Next(src, &pos, &key, nullptr); ++n) {
+        dst[n]._v.obj = key;
+        dst[n]._idx = zs_var_type_object;
+        if (owned) Py_INCREF(key);
+      }
+      _pos = pos;
+      break;
+    }
+    case zs_chunk_iter_set: {
+      auto set = reinterpret_cast<PySetObject *>(src);
+      if (set->used != _size) {
+        PyErr_SetString(PyExc_RuntimeError, "Set changed size during iteration");
+        zs_report_error();
+        _status = -1;
+        return -1;
+      }
+      // active entries hold a key whose hash is not -1, dummies are marked by a -1 hash
+      for (; n < capacity && _pos <= set->mask; ++_pos) {
+        setentry &entry = set->table[_pos];
+        if (!entry.key || entry.hash == -1) continue;
+        dst[n]._v.obj = entry.key;
+        dst[n]._idx = zs_var_type_object;
+        if (owned) Py_INCREF(entry.key);
+        ++n;
+      }
+      break;
+    }
+    case zs_chunk_iter_generic: {
+      if (!owned && _heldCap < capacity) {
+        auto held = static_cast<void **>(PyMem_Realloc(_held, sizeof(void *) * capacity));
+        if (!held) {
+          PyErr_NoMemory();
+          zs_report_error();
+          return -1;
+        }
+        _held = held;
+        _heldCap = capacity;
+      }
+      iternextfunc iternext = Py_TYPE(src)->tp_iternext;
+      for (; n < capacity; ++n) {
+        PyObject *item = iternext(src);
+        if (!item) break;
+        dst[n]._v.obj = item;
+        dst[n]._idx = zs_var_type_object;
+        if (!owned) _held[_numHeld++] = item;
+      }
+      if (n < capacity) {
+        _status = 1;
+        if (PyErr_Occurred()) {
+          if (PyErr_ExceptionMatches(PyExc_StopIteration))
+            PyErr_Clear();
+          else {
+            zs_report_error();
+            // report the failure on the next call, after the items already fetched
+            _status = -1;
+            if (n == 0) return -1;
+          }
+        }
+      }
+      return n;
+    }
+    default:
+      return -1;
+  }
+  if (n < capacity) _status = 1;
+  return n;
+}
+
 #define PY_VAR_DEFINE_COMPARATOR(SYM, TAG)                                              \
   bool PyVar::operator SYM(const PyVar &o) const {                                      \
     if (auto ret = PyObject_RichCompareBool((PyObject *)_obj, (PyObject *)o._obj, TAG); \
         ret == 1) {                                                                     \
       return true;                                                                      \
     } else {                                                                            \
-      if (ret == -1) PyErr_Print();                                                     \
+      if (ret == -1) zs_report_error();                                                 \
       return false;                                                                     \
     }                                                                                   \
   }
@@ -387,29 +906,27 @@ void *PyVar::pytype() const noexcept {
 
 PyVar PyVar::operator()() {
   PyVar ret = PyObject_CallNoArgs((PyObject *)handle());
-  if (!ret) PyErr_Print();
+  if (!ret) zs_report_error();
   return ret;
 }
 PyVar PyVar::operator()(ZsObject obj) {
   PyVar ret = PyObject_CallOneArg((PyObject *)handle(), as_ptr_<PyObject>(obj));
-  if (!ret) PyErr_Print();
+  if (!ret) zs_report_error();
   return ret;
 }
 PyVar PyVar::callObject(ZsTuple args) {
   PyVar ret = PyObject_CallObject((PyObject *)handle(), as_ptr_<PyObject>(args));
-  if (!ret) PyErr_Print();
+  if (!ret) zs_report_error();
   return ret;
 }
 
 PyVar PyVar::operator()(const char *method) {
-  if (PyVar callable = attr(method)) return callable();
-  fprintf(stderr, "method [%s] does not exist.\n", method);
-  return NULL;
+  void *args[1];
+  return vectorcallMethod(method, args, 0, nullptr, 0);
 }
 PyVar PyVar::operator()(const char *method, ZsObject obj) {
-  if (PyVar callable = attr(method)) return callable(obj);
-  fprintf(stderr, "method [%s] does not exist.\n", method);
-  return NULL;
+  void *args[2] = {nullptr, obj.handle()};
+  return vectorcallMethod(method, args, 1, nullptr, 0);
 }
 PyVar PyVar::callMethod(const char *method, ZsTuple args) {
   if (PyVar callable = attr(method)) return callable.callObject(args);
@@ -417,11 +934,70 @@ PyVar PyVar::callMethod(const char *method, ZsTuple args) {
   return NULL;
 }
 
+/// @brief the kwnames tuple of a vectorcall, nullptr if there is no keyword argument
+static bool zs_vectorcall_kwnames(const ZsKey *const *kwnames, sint_t nkwargs, PyObject **names) {
+  *names = nullptr;
+  if (nkwargs == 0) return true;
+  PyObject *tup = PyTuple_New(nkwargs);
+  if (!tup) {
+    zs_report_error();
+    return false;
+  }
+  for (sint_t i = 0; i < nkwargs; ++i) {
+    auto name = static_cast<PyObject *>(kwnames[i]->handle());
+    if (!name) {
+      Py_DECREF(tup);
+      return false;
+    }
+    PyTuple_SET_ITEM(tup, i, Py_NewRef(name));
+  }
+  *names = tup;
+  return true;
+}
+PyVar PyVar::vectorcall(void **args, sint_t nargs, const ZsKey *const *kwnames, sint_t nkwargs) {
+  PyObject *names;
+  if (!zs_vectorcall_kwnames(kwnames, nkwargs, &names)) return NULL;
+  PyVar ret = PyObject_Vectorcall((PyObject *)handle(), reinterpret_cast<PyObject *const *>(args + 1),
+                                  (size_t)nargs | PY_VECTORCALL_ARGUMENTS_OFFSET, names);
+  Py_XDECREF(names);
+  if (!ret) zs_report_error();
+  return ret;
+}
+PyVar PyVar::vectorcallMethod(const char *method, void **args, sint_t nargs,
+                              const ZsKey *const *kwnames, sint_t nkwargs) {
+  PyVar name = PyUnicode_InternFromString(method);
+  if (!name) {
+    zs_report_error();
+    return NULL;
+  }
+  PyObject *names;
+  if (!zs_vectorcall_kwnames(kwnames, nkwargs, &names)) return NULL;
+  args[0] = handle();
+  PyVar ret = PyObject_VectorcallMethod(name, reinterpret_cast<PyObject *const *>(args),
+                                        (size_t)nargs + 1, names);
+  Py_XDECREF(names);
+  if (!ret) zs_report_error();
+  return ret;
+}
+PyVar PyVar::vectorcallMethod(const ZsKey &method, void **args, sint_t nargs,
+                              const ZsKey *const *kwnames, sint_t nkwargs) {
+  auto name = static_cast<PyObject *>(method.handle());
+  if (!name) return NULL;
+  PyObject *names;
+  if (!zs_vectorcall_kwnames(kwnames, nkwargs, &names)) return NULL;
+  args[0] = handle();
+  PyVar ret = PyObject_VectorcallMethod(name, reinterpret_cast<PyObject *const *>(args),
+                                        (size_t)nargs + 1, names);
+  Py_XDECREF(names);
+  if (!ret) zs_report_error();
+  return ret;
+}
+
 bool PyVar::hasAttr(const char *name) { return PyObject_HasAttrString((PyObject *)handle(), name); }
 bool PyVar::setAttr(const char *name, ZsObject attr) {
   if (!attr) return false;
   if (PyObject_SetAttrString((PyObject *)handle(), name, as_ptr_<PyObject>(attr)) == 0) return true;
-  PyErr_Print();
+  zs_report_error();
   return false;
 }
 bool PyVar::delAttr(const char *name) {
@@ -429,7 +1005,7 @@ bool PyVar::delAttr(const char *name) {
 }
 PyVar PyVar::attr(const char *name) {
   PyVar ret = PyObject_GetAttrString((PyObject *)handle(), name);
-  if (!ret) PyErr_Print();
+  if (!ret) zs_report_error();
   return ret;
 }
 
@@ -441,7 +1017,7 @@ bool PyVar::hasItem(const char *name) {
 bool PyVar::setItem(const char *name, ZsObject item) {
   PyVar str = zs_string_obj_cstr(name);
   if (PyObject_SetItem((PyObject *)handle(), str, as_ptr_<PyObject>(item)) == 0) return true;
-  PyErr_Print();
+  zs_report_error();
   return false;
 }
 bool PyVar::delItem(const char *name) {
@@ -452,17 +1028,189 @@ bool PyVar::delItem(const char *name) {
 PyVar PyVar::item(const char *name) {
   PyVar str = zs_string_obj_cstr(name);
   PyVar ret = PyObject_GetItem((PyObject *)handle(), str);
-  if (!ret) PyErr_Print();
+  if (!ret) zs_report_error();
+  return ret;
+}
+
+bool PyVar::hasAttr(const ZsKey &name) {
+  PyObject *key = static_cast<PyObject *>(name.handle());
+  if (!key) return false;
+  return PyObject_HasAttr((PyObject *)handle(), key);
+}
+bool PyVar::setAttr(const ZsKey &name, ZsObject attr) {
+  PyObject *key = static_cast<PyObject *>(name.handle());
+  if (!key || !attr) return false;
+  if (PyObject_SetAttr((PyObject *)handle(), key, as_ptr_<PyObject>(attr)) == 0) return true;
+  zs_report_error();
+  return false;
+}
+bool PyVar::delAttr(const ZsKey &name) {
+  PyObject *key = static_cast<PyObject *>(name.handle());
+  if (!key) return false;
+  return PyObject_DelAttr((PyObject *)handle(), key) != -1;
+}
+PyVar PyVar::attr(const ZsKey &name) {
+  PyObject *key = static_cast<PyObject *>(name.handle());
+  if (!key) return {};
+  PyVar ret = PyObject_GetAttr((PyObject *)handle(), key);
+  if (!ret) zs_report_error();
   return ret;
 }
 
+bool PyVar::hasItem(const ZsKey &name) {
+  PyObject *key = static_cast<PyObject *>(name.handle());
+  if (!key) return false;
+  PyVar ret = PyObject_GetItem((PyObject *)handle(), key);
+  if (!ret) PyErr_Clear();
+  return ret;
+}
+bool PyVar::setItem(const ZsKey &name, ZsObject item) {
+  PyObject *key = static_cast<PyObject *>(name.handle());
+  if (!key) return false;
+  if (PyObject_SetItem((PyObject *)handle(), key, as_ptr_<PyObject>(item)) == 0) return true;
+  zs_report_error();
+  return false;
+}
+bool PyVar::delItem(const ZsKey &name) {
+  PyObject *key = static_cast<PyObject *>(name.handle());
+  if (!key) return false;
+  return PyObject_DelItem((PyObject *)handle(), key) != -1;
+}
+PyVar PyVar::item(const ZsKey &name) {
+  PyObject *key = static_cast<PyObject *>(name.handle());
+  if (!key) return {};
+  PyVar ret = PyObject_GetItem((PyObject *)handle(), key);
+  if (!ret) zs_report_error();
+  return ret;
+}
+
+/// attribute handle
+static unsigned int zs_type_version(PyTypeObject *tp) noexcept {
+  return PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG) ? tp->tp_version_tag : 0;
+}
+/// @brief look \a name up along the mro of \a tp, borrowed, nullptr if missing
+static PyObject *zs_type_lookup(PyTypeObject *tp, PyObject *name) {
+  PyObject *mro = tp->tp_mro;
+  if (!mro) return nullptr;
+  for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(mro); ++i) {
+    auto base = reinterpret_cast<PyTypeObject *>(PyTuple_GET_ITEM(mro, i));
+#if PY_VERSION_HEX >= 0x030C0000
+    PyObject *dict = PyType_GetDict(base);
+    PyObject *ret = dict ? PyDict_GetItemWithError(dict, name) : nullptr;
+    Py_XDECREF(dict);
+#else
+    PyObject *ret = base->tp_dict ? PyDict_GetItemWithError(base->tp_dict, name) : nullptr;
+#endif
+    if (ret) return ret;
+    if (PyErr_Occurred()) {
+      PyErr_Clear();
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+/// @brief whether the attribute \a name of instances of \a tp always resolves the same way, i.e.
+/// the type level entry is absent, no descriptor, or a descriptor known to bind deterministically
+/// @note any other descriptor (properties, custom __get__) may compute a fresh value every time
+static bool zs_type_stable_entry(PyTypeObject *tp, PyObject *name) {
+  PyObject *descr = zs_type_lookup(tp, name);
+  if (!descr) return true;
+  PyTypeObject *descrType = Py_TYPE(descr);
+  return !descrType->tp_descr_get || descrType == &PyFunction_Type
+         || descrType == &PyClassMethod_Type || descrType == &PyStaticMethod_Type
+         || descrType == &PyMethodDescr_Type || descrType == &PyClassMethodDescr_Type;
+}
+
+ZsAttrHandle::~ZsAttrHandle() {
+  if (!_owner && !_type && !_dict && !_entry && !_value) return;
+  /// @note usually a static, thus destroyed at exit on a thread not holding the GIL. After
+  /// finalization the references are leaked on purpose.
+#if PY_VERSION_HEX >= 0x030D0000
+  if (!Py_IsInitialized() || Py_IsFinalizing()) return;
+#else
+  if (!Py_IsInitialized() || _Py_IsFinalizing()) return;
+#endif
+  PyGILState_STATE state = PyGILState_Ensure();
+  reset();
+  PyGILState_Release(state);
+}
+void ZsAttrHandle::reset() {
+  Py_CLEAR(reinterpret_cast<PyObject *&>(_owner));
+  Py_CLEAR(reinterpret_cast<PyObject *&>(_type));
+  Py_CLEAR(reinterpret_cast<PyObject *&>(_dict));
+  Py_CLEAR(reinterpret_cast<PyObject *&>(_entry));
+  Py_CLEAR(reinterpret_cast<PyObject *&>(_value));
+  _typeTag = _ownerTag = 0;
+}
+PyVar ZsAttrHandle::get(ZsObject owner) {
+  auto key = static_cast<PyObject *>(_name.handle());
+  if (!key) return {};
+  auto o = as_ptr_<PyObject>(owner);
+  PyTypeObject *tp = Py_TYPE(o);
+  if (_value && o == _owner && (void *)tp == _type && zs_type_version(tp) == _typeTag
+      && (!_ownerTag || zs_type_version(reinterpret_cast<PyTypeObject *>(o)) == _ownerTag)
+      && (!_dict || PyDict_GetItemWithError(static_cast<PyObject *>(_dict), key) == _entry)) {
+    _stats.hits++;
+    return Py_NewRef(static_cast<PyObject *>(_value));
+  }
+
+  reset();
+  PyObject *value = PyObject_GetAttr(o, key);
+  if (!value) {
+    zs_report_error();
+    return {};
+  }
+  // the version tags are assigned by the lookup above
+  unsigned int typeTag = zs_type_version(tp), ownerTag = 0;
+  PyObject *dict = nullptr;
+  bool cacheable = typeTag != 0 && zs_type_stable_entry(tp, key);
+  if (!cacheable)
+    ;
+  else if (tp->tp_getattro == PyObject_GenericGetAttr) {
+#if PY_VERSION_HEX >= 0x030B0000
+    const bool hasDict = tp->tp_dictoffset != 0 || PyType_HasFeature(tp, Py_TPFLAGS_MANAGED_DICT);
+#else
+    const bool hasDict = tp->tp_dictoffset != 0;
+#endif
+    if (hasDict) {
+      if (!(dict = PyObject_GenericGetDict(o, nullptr))) {
+        PyErr_Clear();
+        cacheable = false;
+      }
+    }
+  } else if (tp->tp_getattro == PyModule_Type.tp_getattro) {
+    // attributes supplied by a module level __getattr__ are not cached
+    dict = Py_XNewRef(PyModule_GetDict(o));
+    cacheable = dict && PyDict_GetItemWithError(dict, key);
+  } else if (tp->tp_getattro == PyType_Type.tp_getattro) {
+    // class attributes go through the descriptors of the owner's own mro as well
+    ownerTag = zs_type_version(reinterpret_cast<PyTypeObject *>(o));
+    cacheable = ownerTag != 0 && zs_type_stable_entry(reinterpret_cast<PyTypeObject *>(o), key);
+  } else
+    cacheable = false;
+
+  if (!cacheable) {
+    Py_XDECREF(dict);
+    _stats.uncached++;
+    return value;
+  }
+  _owner = Py_NewRef(o);
+  _type = Py_NewRef(reinterpret_cast<PyObject *>(tp));
+  _typeTag = typeTag;
+  _ownerTag = ownerTag;
+  if ((_dict = dict)) _entry = Py_XNewRef(PyDict_GetItemWithError(dict, key));
+  _value = Py_NewRef(value);
+  _stats.misses++;
+  return value;
+}
+
 PyVar PyVar::repr() { return zs_string_obj_repr(ZsObject{_obj}); }
 PyVar PyVar::str() { return PyObject_Str(static_cast<PyObject *>(_obj)); }
 PyVar PyVar::bytes() {
   if (!_obj) return Py_None;
   auto ret = PyObject_Dir(static_cast<PyObject *>(_obj));
   if (!ret) {
-    if (PyErr_Occurred()) PyErr_Print();
+    if (PyErr_Occurred()) zs_report_error();
   }
   return ret;
 }
@@ -1,6 +1,7 @@
 #include "ValueInterface.hpp"
 #include "interface/details/Py.hpp"
 #include "interface/details/PyHelper.hpp"
+#include "interface/details/PyClone.hpp"
 
 #ifdef __cplusplus
 extern "C" {
@@ -8,21 +9,186 @@ extern "C" {
 
 static PyEnvInitializer g_py_initializer;
 
-unsigned g_zs_last_error = 0;
-unsigned g_zs_last_warn = 0;
+void zs_interpreter_config_init(ZsInterpreterConfig *config) {
+  if (!config) return;
+  config->isolated = 0;
+  config->utf8Mode = -1;
+  config->installSignalHandlers = 1;
+  config->siteImport = 1;
+  config->releaseGIL = 0;
+  config->verbose = 1;
+  config->home = nullptr;
+  config->programName = nullptr;
+}
+bool zs_initialize(const ZsInterpreterConfig *config) {
+  return g_py_initializer.initialize(config);
+}
+bool zs_is_initialized() {
+  return g_py_initializer.g_initialized.load(std::memory_order_acquire);
+}
+bool zs_ensure_initialized() { return g_py_initializer.ensureInitialized(); }
+void zs_startup_timings(ZsStartupTimings *timings) {
+  if (!timings) return;
+  if (zs_is_initialized())
+    *timings = g_py_initializer.g_startupTimings;
+  else
+    *timings = ZsStartupTimings{};
+}
+
+/// @brief per-thread record of the last failure, see zs_report_error
+/// @note the references held are small (no traceback), and deliberately leaked at thread exit
+/// where taking the GIL may deadlock the process teardown. Worker threads drop them when they
+/// unregister.
+struct ZsErrorRecord {
+  void reset() {
+    Py_CLEAR(type);
+    Py_CLEAR(value);
+    message.clear();
+    formatted = false;
+  }
+
+  unsigned lastError{zs_error_none};
+  unsigned lastWarn{zs_error_none};
+  unsigned quiet{0};
+  PyObject *type{nullptr};
+  PyObject *value{nullptr};  // possibly not normalized, without traceback, NULL once formatted
+  std::string message;
+  bool formatted{false};
+};
+static thread_local ZsErrorRecord g_zs_error;
+static std::atomic<zs_eval_namespace_> g_zs_eval_namespace{zs_eval_namespace_overlay};
+
+unsigned zs_error_code(void *type) {
+  static const std::pair<PyObject **, zs_error_> codes[] = {
+      {&PyExc_KeyError, zs_error_key},
+      {&PyExc_IndexError, zs_error_index},
+      {&PyExc_TypeError, zs_error_type},
+      {&PyExc_ValueError, zs_error_value},
+      {&PyExc_AttributeError, zs_error_attribute},
+      {&PyExc_OverflowError, zs_error_overflow},
+      {&PyExc_ZeroDivisionError, zs_error_zero_division},
+      {&PyExc_MemoryError, zs_error_memory},
+      {&PyExc_StopIteration, zs_error_stop_iteration},
+      {&PyExc_SystemExit, zs_error_system_exit},
+  };
+  for (const auto &[exc, code] : codes)
+    if (PyErr_GivenExceptionMatches(static_cast<PyObject *>(type), *exc)) return code;
+  return zs_error_exception;
+}
+/// @brief drop the tracebacks along the exception chain of \a value (owned by the caller), which
+/// would otherwise pin every frame (and its locals) involved
+/// @note exceptions still referenced elsewhere (e.g. stored by user code to be re-raised) are left
+/// untouched
+/// @return false if the chain reaches such a shared exception, thus might still pin frames
+static bool zs_drop_tracebacks(PyObject *value) {
+  /// references to value other than from the caller or its predecessor in the chain
+  Py_ssize_t expected = 1;
+  /// @note bounded, the chain is expected to be short and acyclic
+  for (int depth = 0; depth < 32 && value && PyExceptionInstance_Check(value); ++depth) {
+    if (Py_REFCNT(value) != expected) return false;
+    PyException_SetTraceback(value, Py_None);
+    PyObject *cause = PyException_GetCause(value);
+    PyObject *context = PyException_GetContext(value);
+    bool shared = false;
+    if (cause && cause != context && PyExceptionInstance_Check(cause)) {
+      /// referenced by value.__cause__ and this function
+      if (Py_REFCNT(cause) == 2)
+        PyException_SetTraceback(cause, Py_None);
+      else
+        shared = true;
+    }
+    /// referenced by value.__context__ (and __cause__ if the same object) from now on
+    expected = cause && cause == context ? 2 : 1;
+    Py_XDECREF(cause);
+    Py_XDECREF(context);  // still referenced by the chain
+    if (shared) return false;
+    value = context;
+  }
+  return true;
+}
+/// @brief "ExceptionType: message" of \a type and \a value (stolen), the python error is kept
+static std::string zs_format_error(PyObject *type, PyObject *value) {
+  PyObject *curType, *curValue, *curTb;
+  PyErr_Fetch(&curType, &curValue, &curTb);
+  PyObject *tb = nullptr;
+  PyErr_NormalizeException(&type, &value, &tb);
+  std::string ret = PyType_Check(type) ? reinterpret_cast<PyTypeObject *>(type)->tp_name : "?";
+  if (PyObject *str = value ? PyObject_Str(value) : nullptr) {
+    if (const char *msg = PyUnicode_AsUTF8(str); msg && msg[0] != '\0')
+      ret.append(": ").append(msg);
+    Py_DECREF(str);
+  }
+  PyErr_Clear();
+  Py_XDECREF(type);
+  Py_XDECREF(value);
+  Py_XDECREF(tb);
+  PyErr_Restore(curType, curValue, curTb);
+  return ret;
+}
+void zs_report_error() {
+  if (!PyErr_Occurred()) return;
+  PyObject *type, *value, *tb;
+  PyErr_Fetch(&type, &value, &tb);
+  auto &record = g_zs_error;
+  record.reset();
+  record.lastError = zs_error_code(type);
+  if (record.quiet) {
+    /// @note the traceback is dropped, the message is formatted only if asked for
+    Py_XDECREF(tb);
+    record.type = type;
+    if (zs_drop_tracebacks(value)) {
+      record.value = value;
+    } else {
+      /// shared with user code, thus formatted right away instead of pinning its frames
+      record.message = zs_format_error(Py_XNewRef(type), value);
+      record.formatted = true;
+    }
+    return;
+  }
+  /// printed anyway, thus formatted right away instead of keeping the exception alive
+  record.type = Py_XNewRef(type);
+  record.message = zs_format_error(Py_XNewRef(type), Py_XNewRef(value));
+  record.formatted = true;
+  PyErr_Restore(type, value, tb);
+  PyErr_Print();
+}
 
 unsigned zs_last_error() {
-  auto ret = g_zs_last_error;
-  g_zs_last_error = 0;  // reset to success (0)
+  auto ret = g_zs_error.lastError;
+  g_zs_error.lastError = zs_error_none;  // reset to success (0)
   return ret;
 }
 unsigned zs_last_warn() {
-  auto ret = g_zs_last_warn;
-  g_zs_last_warn = 0;  // reset to success (0)
+  auto ret = g_zs_error.lastWarn;
+  g_zs_error.lastWarn = zs_error_none;  // reset to success (0)
   return ret;
 }
+const char *zs_last_error_message() {
+  auto &record = g_zs_error;
+  if (!record.type) return "";
+  if (!record.formatted) {
+    record.formatted = true;
+    /// @note the value is no longer needed once formatted
+    record.message = zs_format_error(Py_NewRef(record.type), record.value);
+    record.value = nullptr;
+  }
+  return record.message.c_str();
+}
+ZsValuePort zs_last_error_type() {
+  return zs_obj(g_zs_error.type ? g_zs_error.type : Py_None);
+}
+void zs_clear_error() {
+  g_zs_error.reset();
+  g_zs_error.lastError = zs_error_none;
+}
+void zs_quiet_errors_push() { g_zs_error.quiet++; }
+void zs_quiet_errors_pop() {
+  if (g_zs_error.quiet) g_zs_error.quiet--;
+}
+bool zs_quiet_errors() { return g_zs_error.quiet != 0; }
 
 ZsValuePort zs_world_handle() {
+  zs_ensure_initialized();
   assert(g_py_initializer.g_globalDict != NULL);
   ZsValue ret;
   ret._v.obj = g_py_initializer.g_globalDict;
@@ -30,6 +196,7 @@ ZsValuePort zs_world_handle() {
   return ret;
 }
 ZsValuePort zs_world_local_handle() {
+  zs_ensure_initialized();
   assert(g_py_initializer.g_localDict != NULL);
   ZsValue ret;
   ret._v.obj = g_py_initializer.g_localDict;
@@ -39,54 +206,96 @@ ZsValuePort zs_world_local_handle() {
 
 bool zs_world_pending_input() { return g_py_initializer.pendingInput(); }
 
+/// @brief take what has been written to sys.<name> as python bytes, NULL if nothing was written
+/// @note GIL must be held
+static PyObject *zs_take_output(const char *name) {
+  Buffer *buffer = zs_output_sink_buffer(PySys_GetObject(name));
+  if (!buffer || buffer->size() == 0) return nullptr;
+  const char *first, *second;
+  unsigned long long firstLen, secondLen;
+  buffer->view(&first, &firstLen, &second, &secondLen);
+  PyObject *ret = PyBytes_FromStringAndSize(NULL, firstLen + secondLen);
+  if (ret) {
+    char *dst = PyBytes_AS_STRING(ret);
+    memcpy(dst, first, firstLen);
+    if (secondLen) memcpy(dst + firstLen, second, secondLen);
+  } else
+    PyErr_Clear();
+  buffer->rewind();
+  return ret;
+}
+/// @brief take the stderr text of a failed synchronous execution: \a copied (stolen, see
+/// zs_output_sink_end_stderr_copy) if the text bypassed the sink buffer, otherwise the buffer's
+/// @note GIL must be held
+static PyObject *zs_take_error_output(PyObject *copied) {
+  PyObject *buffered = zs_take_output("stderr");
+  if (!copied) return buffered;
+  Py_XDECREF(buffered);
+  return copied;
+}
+static Buffer *zs_world_output_buffer(zs_output_stream_ stream) {
+  switch (stream) {
+    case zs_output_stream_stdout:
+      return &g_py_initializer.g_stdoutBuffer;
+    case zs_output_stream_stderr:
+      return &g_py_initializer.g_stderrBuffer;
+    default:
+      return nullptr;
+  }
+}
+sint_t zs_world_output_view(zs_output_stream_ stream, const char **first, sint_t *firstLen,
+                            const char **second, sint_t *secondLen) {
+  Buffer *buffer = zs_world_output_buffer(stream);
+  if (!buffer) return -1;
+  unsigned long long n0, n1;
+  buffer->view(first, &n0, second, &n1);
+  *firstLen = n0;
+  *secondLen = n1;
+  return n0 + n1;
+}
+void zs_world_output_consume(zs_output_stream_ stream, sint_t numBytes) {
+  if (Buffer *buffer = zs_world_output_buffer(stream)) buffer->consume(numBytes);
+}
+unsigned long long zs_world_output_dropped(zs_output_stream_ stream) {
+  if (Buffer *buffer = zs_world_output_buffer(stream))
+    return buffer->dropped() + zs_output_sink_stream_dropped(stream);
+  return 0;
+}
+void zs_world_set_output_limit(unsigned long long numBytes) {
+  if (numBytes == 0) return;
+  GILGuard gilGuard;
+  g_py_initializer.g_stdoutBuffer.setLimit(numBytes);
+  g_py_initializer.g_stderrBuffer.setLimit(numBytes);
+}
+
 void *zs_execute_statement(const char *cmd, int *state) {
   PyObject *resultStr = nullptr;
   *state = -1;  // -1: not evaluated/executed
   // 0: success, 1: execution error, 2: pending intput, 3: other syntax error,
   // 4: unknown error, 5: request exit
 
-  g_py_initializer.appendBuffer(cmd, strlen(cmd));
+  const auto cmdLen = strlen(cmd);
+  g_py_initializer.appendBuffer(cmd, cmdLen);
   g_py_initializer.appendBuffer("\n", 1);
-  if (g_py_initializer.pendingInput()) {
-    if (cmd[0] != '\0')  // do not execute yet
-      return nullptr;
-  } else if (cmd[0] == '\0')  // do not execute yet
+  auto &inputState = g_py_initializer.g_inputState;
+  inputState.feed(cmd, cmdLen);
+  if (inputState.blank()) {  // do not execute yet
+    g_py_initializer.rewindBuffer();
     return nullptr;
+  }
 
   /// @ref
   /// https://stackoverflow.com/questions/78216015/issue-with-gil-on-python-3-12-2
-  PyGILState_STATE gstate = PyGILState_Ensure();
+  GILGuard gilGuard;
+  const auto stderrMark = zs_output_sink_begin_stderr_copy();
   {
-    // sprintf(g_py_initializer.g_buffer, "%s\n", cmd);
+    /// @note compiled as codeop.compile_command does, see PyInputState
     if (PyVar compiledCode
-        = Py_CompileString(g_py_initializer.getBuffer(), "<execute user py command>",
-                           Py_single_input))  // Py_file_input, Py_eval_input, Py_single_input
-    {
+        = PyInputState::compile(g_py_initializer.getBuffer(), "<execute user py command>")) {
       /// able to evaluate the script
       if (PyVar res = PyEval_EvalCode(compiledCode, g_py_initializer.g_globalDict,
                                       g_py_initializer.g_localDict)) {
-        if (auto sysStdout = PySys_GetObject("stdout")) {
-          if (PyVar result = PyObject_CallMethod(sysStdout, "getvalue", NULL)) {
-            resultStr = PyUnicode_AsUTF8String(result);
-            if (resultStr) {
-              auto resultCstr = PyBytes_AsString(resultStr);
-
-              if (resultCstr && resultCstr[0] != '\0') {
-                *state = 0;
-              } else {
-                Py_DECREF(resultStr);
-                resultStr = nullptr;
-              }
-            }
-            /// @ref
-            /// https://stackoverflow.com/questions/4330812/how-do-i-clear-a-stringio-object
-            // reset output buffer
-            PyObject_CallMethod(sysStdout, "seek", "i", 0);
-            PyObject_CallMethod(sysStdout, "truncate", "i", 0);
-          } else
-            PyErr_Print();
-        } else
-          PyErr_Print();
+        if ((resultStr = zs_take_output("stdout"))) *state = 0;
       } else if (PyErr_ExceptionMatches(PyExc_SystemExit)) {
         PyErr_Clear();
         *state = 5;
@@ -99,47 +308,18 @@ void *zs_execute_statement(const char *cmd, int *state) {
       }
       g_py_initializer.rewindBuffer();
     }
+    // incomplete input, keep accumulating
+    else if (!PyErr_Occurred()) {
+      if (!g_py_initializer.pendingInput()) {
+        g_py_initializer.setInputPending();
+        *state = 2;
+      }
+    }
     // syntax error
     else if (PyErr_ExceptionMatches(PyExc_SyntaxError)) {
-      PyObject *type, *val, *tb;
-      PyErr_Fetch(&type, &val, &tb);
-      PyErr_NormalizeException(&type, &val, &tb);
-      if (PyErr_GivenExceptionMatches(type, PyExc_SyntaxError)) {
-        // PyVar msg = PyObject_GetAttrString(val, "msg");
-        PyVar msg = zs_string_obj(val);
-        PyVar msgStr = PyUnicode_AsUTF8String(msg);
-        auto msgCstr = PyBytes_AsString(msgStr);
-        /// compound type
-        /// 0: : if/for/func_def
-        /// 1: []
-        /// 2: {}
-        if (cmd[0] != '\0'
-            && (!strcmp(msgCstr, "unexpected EOF while parsing")
-                || !strncmp(msgCstr, "expected an indented block after", 32)
-                || !strncmp(msgCstr + 2, "\' was never closed", 18))) {
-          *state = 2;
-          // printf("incomplete input, require more\n");
-          if (!g_py_initializer.pendingInput())
-            g_py_initializer.setInputPending();  // *
-          else {
-            PyErr_Restore(type, val, tb);  // restore error indicator
-            PyErr_Print();
-          }
-        } else {
-          // other syntax error, like "invalid syntax"
-          *state = 3;
-          PyErr_Restore(type, val, tb);  // restore error indicator
-          PyErr_Print();
-          g_py_initializer.rewindBuffer();
-        }
-        // printf("syntax error: %s\n", msgCstr);
-      } else {
-        // likely non-syntax error
-        *state = 4;
-        PyErr_Restore(type, val, tb);  // restore error indicator
-        PyErr_Print();
-        g_py_initializer.rewindBuffer();
-      }
+      *state = 3;
+      PyErr_Print();
+      g_py_initializer.rewindBuffer();
     }
     // non-syntax error
     else {
@@ -150,31 +330,70 @@ void *zs_execute_statement(const char *cmd, int *state) {
   }
 
   /// error handling
+  PyObject *stderrCopy = static_cast<PyObject *>(zs_output_sink_end_stderr_copy(stderrMark));
   if (*state != -1 && *state != 0 && *state != 2) {
-    if (auto sysStderr = PySys_GetObject("stderr")) {
-      if (PyVar result = PyObject_CallMethod(sysStderr, "getvalue", NULL)) {
-        resultStr = PyUnicode_AsUTF8String(result);
-
-        if (resultStr) {
-          auto resultCstr = PyBytes_AsString(resultStr);
-          if (resultCstr && resultCstr[0] != '\0') {
-            *state = 1;
-            PyObject_CallMethod(sysStderr, "seek", "i", 0);
-            PyObject_CallMethod(sysStderr, "truncate", "i", 0);
-          } else {
-            /// unable to get error string
-            Py_DECREF(resultStr);
-            resultStr = nullptr;
-          }
-        }
-      }  // result
-    }  // sysStderr
-  }
-  PyGILState_Release(gstate);
-
+    if ((resultStr = zs_take_error_output(stderrCopy))) *state = 1;
+  } else
+    Py_XDECREF(stderrCopy);
   return resultStr;
 }
+/// @brief report the pending python error of an evaluation into \a errLogBytes, then clear it
+static void zs_eval_fetch_error(void **errLogBytes) {
+  if (!PyErr_Occurred()) return;
+  if (PyErr_ExceptionMatches(PyExc_SystemExit)) {
+    PyErr_Clear();
+    if (errLogBytes)
+      *errLogBytes
+          = ((ZsBytes)zs_bytes_obj_cstr("\'exit()\' not allowed for evaluation!")).handle();
+  } else {
+    if (errLogBytes) {
+      PyObject *type, *val, *tb;
+      PyErr_Fetch(&type, &val, &tb);
+      PyErr_NormalizeException(&type, &val, &tb);
+      PyVar msg = zs_string_obj(val);
+      // PyVar msg = PyObject_GetAttrString(val, "msg");
+      if (msg) *errLogBytes = PyUnicode_AsUTF8String(msg);
+      PyErr_Restore(type, val, tb);  // restore error indicator
+    }
+    PyErr_Clear();
+  }
+}
+/// @brief evaluate \a code without letting it rebind names of the world (global dict)
+/// @note GIL must be held. Returns a new reference, or NULL with the python error set.
+static PyObject *zs_eval_code_isolated(PyObject *code, unsigned flags, PyObject *bindings) {
+  PyObject *globals = g_py_initializer.g_globalDict;
+  /// @note free names of nested scopes (lambda, comprehension) are resolved through globals
+  /// only, thus per-call bindings and names stored by the expression itself (walrus) have to
+  /// live in a private namespace for them
+  bool privateNamespace = g_zs_eval_namespace.load(std::memory_order_relaxed)
+                              == zs_eval_namespace_copy
+                          || (flags & PyCodeCache::code_flag_globals_access)
+                          || ((flags & PyCodeCache::code_flag_nested_scope)
+                              && ((flags & PyCodeCache::code_flag_store)
+                                  || (bindings && PyDict_GET_SIZE(bindings) > 0)));
+  if (privateNamespace) {
+    PyVar ns = PyDict_Copy(globals);
+    if (!ns) return nullptr;
+    if (bindings && PyDict_Update(ns, bindings) == -1) return nullptr;
+    return PyEval_EvalCode(code, ns, ns);
+  }
+  /// overlay: lookups fall through a small per-call locals dict into the shared globals, while
+  /// stores (e.g. walrus) only ever land in the locals
+  PyVar locals = bindings ? PyDict_Copy(bindings) : PyDict_New();
+  if (!locals) return nullptr;
+  return PyEval_EvalCode(code, globals, locals);
+}
+void zs_set_eval_namespace(zs_eval_namespace_ mode) {
+  g_zs_eval_namespace.store(mode, std::memory_order_relaxed);
+}
+zs_eval_namespace_ zs_get_eval_namespace() {
+  return g_zs_eval_namespace.load(std::memory_order_relaxed);
+}
+
 void *zs_eval_expr(const char *expr, void **errLogBytes) {
+  return zs_eval_expr_with_bindings(expr, ZsValue{}, errLogBytes);
+}
+void *zs_eval_expr_with_bindings(const char *expr, ZsValue bindings, void **errLogBytes) {
   if (errLogBytes) *errLogBytes = nullptr;
 
   if (expr[0] == '\0')  // do not execute yet
@@ -184,57 +403,94 @@ void *zs_eval_expr(const char *expr, void **errLogBytes) {
   {
     GILGuard gilGuard;
 
-    if (PyVar compiledCode
-        = Py_CompileString(expr, "<evaluate user py expression>", Py_eval_input)) {
+    PyObject *bindingsDict = nullptr;
+    if (!bindings.isNone()) {
+      if (!bindings.isObject() || !PyDict_Check(static_cast<PyObject *>(bindings._v.obj))) {
+        if (errLogBytes)
+          *errLogBytes = ((ZsBytes)zs_bytes_obj_cstr("eval bindings should be a dict.")).handle();
+        return nullptr;
+      }
+      bindingsDict = static_cast<PyObject *>(bindings._v.obj);
+    }
+
+    unsigned flags = 0;
+    if (PyVar compiledCode = g_py_initializer.g_codeCache.compile(
+            expr, "<evaluate user py expression>", Py_eval_input, &flags)) {
       /// able to evaluate the script
-      PyVar copiedDict = zs_dict_obj_copy(g_py_initializer.g_globalDict);
-      if (copiedDict) {
-        if (result = PyEval_EvalCode(compiledCode, copiedDict, copiedDict); !result) {
-          if (PyErr_Occurred()) {
-            /// @note evaluation error happened
-            if (PyErr_ExceptionMatches(PyExc_SystemExit)) {
-              PyErr_Clear();
-              if (errLogBytes)
-                *errLogBytes
-                    = ((ZsBytes)zs_bytes_obj_cstr("\'exit()\' not allowed for evaluation!"))
-                          .handle();
+      if (result = zs_eval_code_isolated(compiledCode, flags, bindingsDict); !result)
+        /// @note evaluation error happened
+        zs_eval_fetch_error(errLogBytes);
+    } else {
+      /// @note compilation error happend
+      zs_eval_fetch_error(errLogBytes);
+    }
+  }  // GIL context
+
+  return result;
+}
+sint_t zs_eval_expr_batch(const char *const *exprs, sint_t count, const ZsValuePort *bindings,
+                          ZsValuePort *results, int *states, void **errLogBytes) {
+  // state -1: not evaluated (empty expr), 0: success, 1: compilation error, 2: evaluation
+  // error, 3: invalid bindings, 5: request exit
+  sint_t numSucceeded = 0;
+  GILGuard gilGuard;
+  for (sint_t i = 0; i < count; ++i) {
+    ZsValue &result = static_cast<ZsValue &>(results[i]);
+    result = ZsValue{};
+    int state = -1;
+    void **errLog = errLogBytes ? &errLogBytes[i] : nullptr;
+    if (errLog) *errLog = nullptr;
+
+    const char *expr = exprs[i];
+    if (expr && expr[0] != '\0') {
+      PyObject *bindingsDict = nullptr;
+      if (bindings) {
+        ZsValue binding{bindings[i]};
+        if (!binding.isNone()) {
+          if (binding.isObject() && PyDict_Check(static_cast<PyObject *>(binding._v.obj)))
+            bindingsDict = static_cast<PyObject *>(binding._v.obj);
+          else
+            state = 3;
+        }
+      }
+
+      unsigned flags = 0;
+      if (state == 3) {
+        if (errLog)
+          *errLog = ((ZsBytes)zs_bytes_obj_cstr("eval bindings should be a dict.")).handle();
+      } else if (PyVar compiledCode = g_py_initializer.g_codeCache.compile(
+                     expr, "<evaluate user py expression>", Py_eval_input, &flags)) {
+        if (PyObject *res = zs_eval_code_isolated(compiledCode, flags, bindingsDict)) {
+          state = 0;
+          /// @note hand plain int/float results back as native values
+          if (Py_TYPE(res) == &PyFloat_Type) {
+            result = ZsValue{zs_f64(PyFloat_AS_DOUBLE(res))};
+            Py_DECREF(res);
+          } else if (Py_TYPE(res) == &PyLong_Type) {
+            int overflow = 0;
+            long long v = PyLong_AsLongLongAndOverflow(res, &overflow);
+            if (overflow == 0 && !(v == -1 && PyErr_Occurred())) {
+              result = ZsValue{zs_i64(v)};
+              Py_DECREF(res);
             } else {
-              if (errLogBytes) {
-                PyObject *type, *val, *tb;
-                PyErr_Fetch(&type, &val, &tb);
-                PyErr_NormalizeException(&type, &val, &tb);
-                PyVar msg = zs_string_obj(val);
-                // PyVar msg = PyObject_GetAttrString(val, "msg");
-                if (msg) *errLogBytes = PyUnicode_AsUTF8String(msg);
-                PyErr_Restore(type, val, tb);  // restore error indicator
-              }
               PyErr_Clear();
+              result = ZsValue{zs_obj(res)};
             }
-          }
+          } else
+            result = ZsValue{zs_obj(res)};
+        } else {
+          state = PyErr_ExceptionMatches(PyExc_SystemExit) ? 5 : 2;
+          zs_eval_fetch_error(errLog);
         }
       } else {
-        if (errLogBytes)
-          *errLogBytes
-              = ((ZsBytes)zs_bytes_obj_cstr("unable to preserve global dict for eval.")).handle();
-      }
-    } else {
-      if (PyErr_Occurred()) {
-        /// @note compilation error happend
-        if (errLogBytes) {
-          PyObject *type, *val, *tb;
-          PyErr_Fetch(&type, &val, &tb);
-          PyErr_NormalizeException(&type, &val, &tb);
-          PyVar msg = zs_string_obj(val);
-          // PyVar msg = PyObject_GetAttrString(val, "msg");
-          if (msg) *errLogBytes = PyUnicode_AsUTF8String(msg);
-          PyErr_Restore(type, val, tb);  // restore error indicator
-        }
-        PyErr_Clear();
+        state = 1;
+        zs_eval_fetch_error(errLog);
       }
     }
-  }  // GIL context
-
-  return result;
+    if (state == 0) numSucceeded++;
+    if (states) states[i] = state;
+  }
+  return numSucceeded;
 }
 void *zs_execute_script(const char *cmd, int *state) {
   PyObject *resultStr = nullptr;
@@ -247,40 +503,20 @@ void *zs_execute_script(const char *cmd, int *state) {
 
   /// @ref
   /// https://stackoverflow.com/questions/78216015/issue-with-gil-on-python-3-12-2
-  PyGILState_STATE gstate = PyGILState_Ensure();
+  GILGuard gilGuard;
+  const auto stderrMark = zs_output_sink_begin_stderr_copy();
   {
     // printf("compiling %s\n", cmd);
     // sprintf(g_py_initializer.g_buffer, "%s\n", cmd);
     if (PyVar compiledCode
-        = Py_CompileString(cmd, "<execute user py file script>",
-                           Py_file_input))  // Py_file_input, Py_eval_input, Py_single_input
+        = g_py_initializer.g_codeCache.compile(cmd, "<execute user py file script>",
+                                               Py_file_input))  // Py_file_input, Py_eval_input, Py_single_input
     {
       /// able to evaluate the script
       if (PyVar res = PyEval_EvalCode(compiledCode, g_py_initializer.g_globalDict,
                                       g_py_initializer.g_localDict)) {
-        if (auto sysStdout = PySys_GetObject("stdout")) {
-          if (PyVar result = PyObject_CallMethod(sysStdout, "getvalue", NULL)) {
-            resultStr = PyUnicode_AsUTF8String(result);
-            if (resultStr) {
-              auto resultCstr = PyBytes_AsString(resultStr);
-
-              *state = 0;
-              if (resultCstr && resultCstr[0] != '\0') {
-                /// @ref
-                /// https://stackoverflow.com/questions/4330812/how-do-i-clear-a-stringio-object
-                // reset output buffer
-                PyObject_CallMethod(sysStdout, "seek", "i", 0);
-                PyObject_CallMethod(sysStdout, "truncate", "i", 0);
-              } else {
-                Py_DECREF(resultStr);
-                resultStr = nullptr;
-              }
-            } else
-              PyErr_Print();
-          } else
-            PyErr_Print();
-        } else
-          PyErr_Print();
+        *state = 0;
+        resultStr = zs_take_output("stdout");
       } else if (PyErr_ExceptionMatches(PyExc_SystemExit)) {
         PyErr_Clear();
         *state = 5;
@@ -299,29 +535,327 @@ void *zs_execute_script(const char *cmd, int *state) {
   }
 
   /// error handling
+  PyObject *stderrCopy = static_cast<PyObject *>(zs_output_sink_end_stderr_copy(stderrMark));
   if (*state != -1 && *state != 0) {
-    if (auto sysStderr = PySys_GetObject("stderr")) {
-      if (PyVar result = PyObject_CallMethod(sysStderr, "getvalue", NULL)) {
-        resultStr = PyUnicode_AsUTF8String(result);
-
-        if (resultStr) {
-          auto resultCstr = PyBytes_AsString(resultStr);
-          if (resultCstr && resultCstr[0] != '\0') {
-            *state = 1;
-            PyObject_CallMethod(sysStderr, "seek", "i", 0);
-            PyObject_CallMethod(sysStderr, "truncate", "i", 0);
-          } else {
-            /// unable to get error string
-            Py_DECREF(resultStr);
-            resultStr = nullptr;
-          }
-        }
-      }  // result
-    }  // sysStderr
+    if ((resultStr = zs_take_error_output(stderrCopy))) *state = 1;
+  } else
+    Py_XDECREF(stderrCopy);
+  return resultStr;
+}
+
+ZsJobHandle zs_execute_script_async(const char *cmd, zs_job_callback_t callback,
+                                    void *userData) {
+  if (!cmd) return 0;
+  zs_ensure_initialized();
+  g_py_initializer.releaseMainThreadGIL();
+  return g_py_initializer.g_worker.submit(
+      [cmd = std::string{cmd}](int *state, void **errLogBytes) -> void * {
+        if (errLogBytes) *errLogBytes = nullptr;
+        return zs_execute_script(cmd.c_str(), state);
+      },
+      callback, userData);
+}
+ZsJobHandle zs_eval_expr_async(const char *expr, zs_job_callback_t callback, void *userData) {
+  if (!expr) return 0;
+  zs_ensure_initialized();
+  g_py_initializer.releaseMainThreadGIL();
+  return g_py_initializer.g_worker.submit(
+      [expr = std::string{expr}](int *state, void **errLogBytes) -> void * {
+        void *ret = zs_eval_expr(expr.c_str(), errLogBytes);
+        *state = ret ? 0 : (expr.empty() ? -1 : 2);
+        return ret;
+      },
+      callback, userData);
+}
+zs_job_status_ zs_job_status(ZsJobHandle job) { return g_py_initializer.g_worker.status(job); }
+zs_job_status_ zs_job_wait(ZsJobHandle job, long long timeoutMs) {
+  /// the job can only make progress once the caller's GIL (if any) is available
+  GILRelease release;
+  return g_py_initializer.g_worker.wait(job, timeoutMs);
+}
+bool zs_job_cancel(ZsJobHandle job) { return g_py_initializer.g_worker.cancel(job); }
+void *zs_job_result(ZsJobHandle job, int *state, void **errLogBytes) {
+  return g_py_initializer.g_worker.take(job, state, errLogBytes);
+}
+void zs_job_release(ZsJobHandle job) { g_py_initializer.g_worker.release(job); }
+
+void zs_payload_release(ZsPayload *payload) {
+  if (!payload) return;
+  free(payload->data);
+  payload->data = nullptr;
+  payload->len = 0;
+  payload->type = zs_payload_none;
+}
+static bool zs_payload_assign_bytes(ZsPayload *payload, zs_payload_type_ type, const void *src,
+                                    sint_t numBytes, sint_t len) {
+  payload->data = malloc(numBytes > 0 ? numBytes : 1);
+  if (!payload->data) return false;
+  if (numBytes > 0) memcpy(payload->data, src, numBytes);
+  payload->len = len;
+  payload->type = type;
+  return true;
+}
+ZsValuePort zs_payload_to_obj(const ZsPayload *payload) {
+  if (!payload) return zs_obj(Py_None);
+  switch (payload->type) {
+    case zs_payload_i64:
+      return zs_long_obj_long_long(payload->v.i64);
+    case zs_payload_f64:
+      return zs_float_obj_double(payload->v.f64);
+    case zs_payload_bytes:
+      return zs_bytes_obj_cstr_range(static_cast<const char *>(payload->data), payload->len);
+    case zs_payload_i64_array:
+    case zs_payload_f64_array: {
+      /// @note the data is copied, the resulting memoryview owns it through a bytes object
+      const bool isInt = payload->type == zs_payload_i64_array;
+      PyVar bytes = PyBytes_FromStringAndSize(static_cast<const char *>(payload->data),
+                                              payload->len * 8);
+      if (!bytes) break;
+      PyVar view = PyMemoryView_FromObject(bytes);
+      if (!view) break;
+      if (auto ret = PyObject_CallMethod(view, "cast", "s", isInt ? "q" : "d")) return zs_obj(ret);
+      break;
+    }
+    default:;
+  }
+  if (PyErr_Occurred()) zs_report_error();
+  return zs_obj(Py_None);
+}
+bool zs_payload_from_obj(ZsValue obj, ZsPayload *payload) {
+  if (!payload) return false;
+  payload->type = zs_payload_none;
+  payload->data = nullptr;
+  payload->len = 0;
+  if (obj.isIntegral() && !obj.isObject()) {
+    payload->type = zs_payload_i64;
+    payload->v.i64 = obj._idx == zs_var_type_i64   ? obj._v.i64
+                     : obj._idx == zs_var_type_i32 ? obj._v.i32
+                                                   : obj._v.i8;
+    return true;
+  }
+  if (obj.isFloatingPoint() && !obj.isObject()) {
+    payload->type = zs_payload_f64;
+    payload->v.f64 = obj._idx == zs_var_type_f64 ? obj._v.f64 : obj._v.f32;
+    return true;
   }
-  PyGILState_Release(gstate);
+  if (obj.isCstr())
+    return zs_payload_assign_bytes(payload, zs_payload_bytes, obj._v.cstr,
+                                   (sint_t)strlen(obj._v.cstr), (sint_t)strlen(obj._v.cstr));
+  if (!obj.isObject()) return obj.isNone();
 
-  return resultStr;
+  PyObject *o = static_cast<PyObject *>(obj._v.obj);
+  if (!o || o == Py_None) return true;
+  if (PyLong_Check(o)) {
+    int overflow = 0;
+    payload->v.i64 = PyLong_AsLongLongAndOverflow(o, &overflow);
+    if (overflow || PyErr_Occurred()) {
+      PyErr_Clear();
+      return false;
+    }
+    payload->type = zs_payload_i64;
+    return true;
+  }
+  if (PyFloat_Check(o)) {
+    payload->type = zs_payload_f64;
+    payload->v.f64 = PyFloat_AS_DOUBLE(o);
+    return true;
+  }
+  if (PyBytes_Check(o))
+    return zs_payload_assign_bytes(payload, zs_payload_bytes, PyBytes_AS_STRING(o),
+                                   PyBytes_GET_SIZE(o), PyBytes_GET_SIZE(o));
+  if (PyByteArray_Check(o))
+    return zs_payload_assign_bytes(payload, zs_payload_bytes, PyByteArray_AS_STRING(o),
+                                   PyByteArray_GET_SIZE(o), PyByteArray_GET_SIZE(o));
+  if (PyUnicode_Check(o)) {
+    Py_ssize_t len = 0;
+    const char *st = PyUnicode_AsUTF8AndSize(o, &len);
+    if (!st) {
+      PyErr_Clear();
+      return false;
+    }
+    return zs_payload_assign_bytes(payload, zs_payload_bytes, st, len, len);
+  }
+  if (PyObject_CheckBuffer(o)) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(o, &view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0) {
+      PyErr_Clear();
+      return false;
+    }
+    /// @note native byte order only
+    const char *fmt = view.format ? view.format : "B";
+    if (*fmt == '@' || *fmt == '=') fmt++;
+    bool ret = false;
+    if (view.itemsize == 8 && (!strcmp(fmt, "d")))
+      ret = zs_payload_assign_bytes(payload, zs_payload_f64_array, view.buf, view.len,
+                                    view.len / 8);
+    else if (view.itemsize == 8 && (!strcmp(fmt, "q") || !strcmp(fmt, "l")))
+      ret = zs_payload_assign_bytes(payload, zs_payload_i64_array, view.buf, view.len,
+                                    view.len / 8);
+    PyBuffer_Release(&view);
+    return ret;
+  }
+  return false;
+}
+
+/// @note GIL of the current (pooled) interpreter must be held
+static bool zs_interp_pool_bind(PyObject *ns, const ZsPayload *inputs, sint_t numInputs) {
+  for (sint_t i = 0; i < numInputs; ++i) {
+    if (!inputs[i].name) return false;
+    PyVar obj{zs_payload_to_obj(&inputs[i])};
+    if (!obj && inputs[i].type != zs_payload_none) return false;
+    if (PyDict_SetItemString(ns, inputs[i].name, obj ? (PyObject *)obj : Py_None) != 0) {
+      PyErr_Clear();
+      return false;
+    }
+  }
+  return true;
+}
+static void zs_interp_pool_assign_msg(ZsPayload *payload, const char *msg) {
+  if (payload) zs_payload_assign_bytes(payload, zs_payload_bytes, msg, strlen(msg), strlen(msg));
+}
+/// @note take the pending python error as a message, see zs_eval_fetch_error
+static void zs_interp_pool_fetch_error(ZsPayload *errLog) {
+  void *errLogBytes = nullptr;
+  zs_eval_fetch_error(errLog ? &errLogBytes : nullptr);
+  if (PyVar msg = errLogBytes) zs_payload_from_obj(ZsValue{zs_obj(msg)}, errLog);
+}
+
+sint_t zs_interp_pool_start(sint_t numInterpreters) {
+  if (numInterpreters <= 0) {
+    g_py_initializer.g_interpPool.stop();
+    return 0;
+  }
+  /// @note sub-interpreters are created from the pooled threads, which need the main GIL
+  zs_ensure_initialized();
+  g_py_initializer.releaseMainThreadGIL();
+  return (sint_t)g_py_initializer.g_interpPool.start((size_t)numInterpreters);
+}
+void zs_interp_pool_stop() { g_py_initializer.g_interpPool.stop(); }
+sint_t zs_interp_pool_size() { return (sint_t)g_py_initializer.g_interpPool.size(); }
+
+int zs_interp_pool_eval_expr(const char *expr, const ZsPayload *inputs, sint_t numInputs,
+                             ZsPayload *result, ZsPayload *errLog) {
+  // state -1: not evaluated (empty expr), 0: success, 1: compilation error, 2: evaluation
+  // error, 3: payload conversion error, 4: pool not running, 5: request exit
+  if (result) zs_payload_from_obj(ZsValue{}, result);
+  if (errLog) zs_payload_from_obj(ZsValue{}, errLog);
+  if (!expr || expr[0] == '\0') return -1;
+
+  int state = 4;
+  g_py_initializer.g_interpPool.run([&](PyObject *world, PyCodeCache &codeCache) {
+    PyVar locals = PyDict_New();
+    if (!locals || !zs_interp_pool_bind(locals, inputs, numInputs)) {
+      state = 3;
+      zs_interp_pool_assign_msg(errLog, "invalid input payloads.");
+      return;
+    }
+    PyVar code = codeCache.compile(expr, "<evaluate pooled py expression>", Py_eval_input);
+    if (!code) {
+      state = 1;
+      zs_interp_pool_fetch_error(errLog);
+      return;
+    }
+    PyVar res = PyEval_EvalCode(code, world, locals);
+    if (!res) {
+      state = PyErr_ExceptionMatches(PyExc_SystemExit) ? 5 : 2;
+      zs_interp_pool_fetch_error(errLog);
+      return;
+    }
+    if (result && !zs_payload_from_obj(ZsValue{zs_obj(res)}, result)) {
+      state = 3;
+      zs_interp_pool_assign_msg(errLog, "evaluation result is not representable as a payload.");
+      return;
+    }
+    state = 0;
+  });
+  return state;
+}
+int zs_interp_pool_execute_script(const char *cmd, const ZsPayload *inputs, sint_t numInputs,
+                                  ZsPayload *result, ZsPayload *output) {
+  // state -1: not executed (empty script), 0: success, 1: execution error, 2: compilation
+  // error, 3: payload conversion error, 4: pool not running, 5: request exit
+  if (result) zs_payload_from_obj(ZsValue{}, result);
+  if (output) zs_payload_from_obj(ZsValue{}, output);
+  if (!cmd || cmd[0] == '\0') return -1;
+
+  int state = 4;
+  g_py_initializer.g_interpPool.run([&](PyObject *world, PyCodeCache &codeCache) {
+    PyVar ns = PyDict_Copy(world);
+    if (!ns || !zs_interp_pool_bind(ns, inputs, numInputs)) {
+      state = 3;
+      zs_interp_pool_assign_msg(output, "invalid input payloads.");
+      return;
+    }
+    /// capture sys.stdout/sys.stderr of this interpreter during the run
+    PyVar io = PyImport_ImportModule("io");
+    PyVar out = io ? PyObject_CallMethod(io, "StringIO", NULL) : nullptr;
+    PyVar err = io ? PyObject_CallMethod(io, "StringIO", NULL) : nullptr;
+    if (!out || !err) {
+      PyErr_Print();
+      return;
+    }
+    PyVar oldStdout = Py_XNewRef(PySys_GetObject("stdout"));
+    PyVar oldStderr = Py_XNewRef(PySys_GetObject("stderr"));
+    PySys_SetObject("stdout", out);
+    PySys_SetObject("stderr", err);
+
+    if (PyVar code = codeCache.compile(cmd, "<execute pooled py script>", Py_file_input)) {
+      if (PyVar res = PyEval_EvalCode(code, ns, ns)) {
+        state = 0;
+      } else if (PyErr_ExceptionMatches(PyExc_SystemExit)) {
+        PyErr_Clear();
+        state = 5;
+      } else {
+        state = 1;
+        PyErr_Print();
+      }
+    } else {
+      state = 2;
+      PyErr_Print();
+    }
+
+    PySys_SetObject("stdout", oldStdout);
+    PySys_SetObject("stderr", oldStderr);
+    if (output) {
+      if (PyVar text = PyObject_CallMethod(state == 0 ? out : err, "getvalue", NULL))
+        zs_payload_from_obj(ZsValue{zs_obj(text)}, output);
+      else
+        PyErr_Clear();
+    }
+    if (result && state == 0)
+      if (PyObject *ret = PyDict_GetItemString(ns, "zs_result"))
+        if (!zs_payload_from_obj(ZsValue{zs_obj(ret)}, result)) state = 3;
+  });
+  return state;
+}
+
+void zs_code_cache_stats(ZsCodeCacheStats *stats) {
+  if (!stats) return;
+  auto ret = g_py_initializer.g_codeCache.stats();
+  stats->hits = ret.hits;
+  stats->misses = ret.misses;
+  stats->evictions = ret.evictions;
+  stats->size = ret.size;
+  stats->capacity = ret.capacity;
+}
+void zs_code_cache_set_capacity(unsigned long long capacity) {
+  GILGuard gilGuard;
+  g_py_initializer.g_codeCache.setCapacity(capacity);
+}
+void zs_code_cache_clear() {
+  GILGuard gilGuard;
+  g_py_initializer.g_codeCache.clear();
+}
+bool zs_bytecode_cache_set_directory(const char *directory) {
+  return g_py_initializer.g_bytecodeCache.setDirectory(directory);
+}
+void zs_bytecode_cache_stats(ZsBytecodeCacheStats *stats) {
+  if (!stats) return;
+  auto ret = g_py_initializer.g_bytecodeCache.stats();
+  stats->hits = ret.hits;
+  stats->misses = ret.misses;
+  stats->writes = ret.writes;
+  stats->rejected = ret.rejected;
 }
 
 ///
@@ -355,6 +889,18 @@ bool zs_default_init_obj(ZsValue *obj, zs_obj_type_ objType, ZsValue arg) {
       obj->_v.obj = static_cast<void *>(arg);
       obj->_idx = obj->_v.obj ? zs_var_type_object : zs_var_type_none;
       return obj->_idx != zs_var_type_none;
+    case zs_obj_type_buffer:
+      /// same as custom, for objects exporting the buffer protocol only
+      if (!arg.isObject() || !PyObject_CheckBuffer(as_ptr_<PyObject>(arg))) return false;
+      obj->_v.obj = static_cast<void *>(arg);
+      obj->_idx = zs_var_type_object;
+      return true;
+    case zs_obj_type_plist:
+      *obj = ZsValue(arg.isObject() ? zs_plist_obj(arg) : zs_plist_obj_default());
+      return zs_get_obj_type(*obj) == zs_obj_type_plist;
+    case zs_obj_type_pmap:
+      *obj = ZsValue(arg.isObject() ? zs_pmap_obj(arg) : zs_pmap_obj_default());
+      return zs_get_obj_type(*obj) == zs_obj_type_pmap;
     default:;
   }
   return false;
@@ -368,12 +914,13 @@ void zs_default_deinit(ZsValue *var) {
 ZsValuePort zs_default_clone(ZsValue v) {
   if (v._idx == zs_var_type_object) {
     auto original = static_cast<PyObject *>(v._v.obj);
-    auto deepcopyFunction = PyDict_GetItemString(g_py_initializer.g_globalDict, "zs_deepcopy");
-    auto copied = PyObject_CallFunctionObjArgs(deepcopyFunction, original, NULL);
+    /// @note builtin containers and immutables are cloned natively, see PyCloner
+    PyCloner cloner{g_py_initializer.g_globalDict};
+    auto copied = cloner.clone(original);
     if (copied) {
       return zs_obj(copied);
     } else {
-      PyErr_Print();
+      zs_report_error();
       return ZsValue{};
     }
   } else {
@@ -456,7 +1003,7 @@ bool zs_default_eq(ZsValue l, ZsValue r) {
     if (Py_TYPE(lobj) == Py_TYPE(robj)) {
       int res = PyObject_RichCompareBool(lobj, robj, Py_EQ);
       if (res == -1) {
-        PyErr_Print();
+        zs_report_error();
       }
       return res == 1;
     } else
@@ -552,7 +1099,7 @@ bool zs_default_ne(ZsValue l, ZsValue r) {
     if (Py_TYPE(lobj) == Py_TYPE(robj)) {
       int res = PyObject_RichCompareBool(lobj, robj, Py_NE);
       if (res == -1) {
-        PyErr_Print();
+        zs_report_error();
       }
       return res == 1;
     } else
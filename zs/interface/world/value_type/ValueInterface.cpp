@@ -4,6 +4,7 @@
 #include <float.h>
 
 #include "interface/details/PyHelper.hpp"
+#include "interface/details/PyPersistent.hpp"
 
 static_assert(sizeof(sint_t) == sizeof(Py_ssize_t),
               "sint_t not a proper replacement for Py_ssize_t");
@@ -71,12 +72,58 @@ zs_obj_type_ zs_get_obj_type(ZsValue obj) {
       return zs_obj_type_dict;
     else if (tp == &PyModule_Type)
       return zs_obj_type_module;
+    else if (int kind = zs_persistent_kind(pyobj))
+      return kind == 1 ? zs_obj_type_plist : zs_obj_type_pmap;
+    else if (PyObject_CheckBuffer(pyobj))
+      return zs_obj_type_buffer;
     else
       return zs_obj_type_custom;
   }
   return zs_obj_type_unknown;
 }
 
+zs_obj_type_ zs_classify_obj_type(ZsValue obj) {
+  if (obj._idx != zs_var_type_object || !obj._v.obj) return zs_obj_type_unknown;
+  auto pyobj = static_cast<PyObject *>(obj._v.obj);
+  auto tp = Py_TYPE(pyobj);
+  /// @note the fast subclass bits cover the most common builtins with a single load
+  auto flags = PyType_GetFlags(tp);
+  if (flags & Py_TPFLAGS_LONG_SUBCLASS)
+    return zs_obj_type_long;
+  else if (flags & Py_TPFLAGS_LIST_SUBCLASS)
+    return zs_obj_type_list;
+  else if (flags & Py_TPFLAGS_TUPLE_SUBCLASS)
+    return zs_obj_type_tuple;
+  else if (flags & Py_TPFLAGS_UNICODE_SUBCLASS)
+    return zs_obj_type_string;
+  else if (flags & Py_TPFLAGS_DICT_SUBCLASS)
+    return zs_obj_type_dict;
+  else if (flags & Py_TPFLAGS_BYTES_SUBCLASS)
+    return zs_obj_type_bytes;
+  else if (PyFloat_Check(pyobj))
+    return zs_obj_type_float;
+  else if (PyByteArray_Check(pyobj))
+    return zs_obj_type_bytearray;
+  else if (PySet_Check(pyobj))
+    return zs_obj_type_set;
+  else if (PyModule_Check(pyobj))
+    return zs_obj_type_module;
+  else if (int kind = zs_persistent_kind(pyobj))
+    return kind == 1 ? zs_obj_type_plist : zs_obj_type_pmap;
+  else if (PyObject_CheckBuffer(pyobj))
+    return zs_obj_type_buffer;
+  return zs_obj_type_custom;
+}
+
+unsigned zs_get_obj_features(ZsValue obj) {
+  if (obj._idx != zs_var_type_object || !obj._v.obj) return zs_obj_feature_none;
+  auto pyobj = static_cast<PyObject *>(obj._v.obj);
+  unsigned features = zs_obj_feature_none;
+  /// @note same criteria as iter(): __iter__, or the legacy __getitem__ sequence protocol
+  if (Py_TYPE(pyobj)->tp_iter || PySequence_Check(pyobj)) features |= zs_obj_feature_iterable;
+  return features;
+}
+
 ZsValuePort zs_cstr(const char *cstr) {
   ZsValue ret;
   ret._v.cstr = cstr;
@@ -138,7 +185,7 @@ ZsValue::operator long long int() const {
       long long res = PyLong_AsLongLongAndOverflow(static_cast<PyObject *>(_v.obj), &overflow);
       if (overflow == 0) {
         if (res == -1)
-          if (PyErr_Occurred()) PyErr_Print();
+          if (PyErr_Occurred()) zs_report_error();
       } else
         zs_print_err_py_cstr("[ZsValue::operator long long int()]: overflow!\n");
       return res;
@@ -163,7 +210,7 @@ ZsValue::operator double() const {
     case zs_var_type_object: {
       double res = PyFloat_AsDouble(static_cast<PyObject *>(_v.obj));
       if (res == -1.0)
-        if (PyErr_Occurred()) PyErr_Print();
+        if (PyErr_Occurred()) zs_report_error();
       return res;
     }
     default:
@@ -184,7 +231,7 @@ ZsValue::operator int() const {
       long long res = PyLong_AsLongLongAndOverflow(static_cast<PyObject *>(_v.obj), &overflow);
       if (overflow == 0) {
         if (res == -1)
-          if (PyErr_Occurred()) PyErr_Print();
+          if (PyErr_Occurred()) zs_report_error();
         if (res <= INT_MAX && res >= INT_MIN) return res;
       }
       zs_print_err_py_cstr("[ZsValue::operator int()]: overflow!\n");
@@ -210,7 +257,7 @@ ZsValue::operator float() const {
     case zs_var_type_object: {
       double res = PyFloat_AsDouble(static_cast<PyObject *>(_v.obj));
       if (res == -1.0)
-        if (PyErr_Occurred()) PyErr_Print();
+        if (PyErr_Occurred()) zs_report_error();
       if (res >= -FLT_MAX && res <= FLT_MAX) return res;
       zs_print_err_py_cstr("[ZsValue::operator float()]: overflow!\n");
       return -1.f;
@@ -242,6 +289,52 @@ ZsValue::operator void *() const {
   }
 }
 
+/// @brief code of the pending python error, which is cleared
+static unsigned zs_take_error_code() {
+  PyObject *type = PyErr_Occurred();
+  unsigned code = type ? zs_error_code(type) : zs_error_exception;
+  PyErr_Clear();
+  return code;
+}
+static unsigned zs_pyobj_try_i64(PyObject *o, long long *out) {
+  if (!PyLong_CheckExact(o)) {
+    // bool, int subclasses and __index__ implementors, but never floats
+    if (!PyIndex_Check(o)) return zs_error_type;
+    PyObject *idx = PyNumber_Index(o);
+    if (!idx) return zs_take_error_code();
+    unsigned status = zs_pyobj_try_i64(idx, out);
+    Py_DECREF(idx);
+    return status;
+  }
+  int overflow = 0;
+  long long res = PyLong_AsLongLongAndOverflow(o, &overflow);
+  if (overflow) return zs_error_overflow;
+  if (res == -1 && PyErr_Occurred()) return zs_take_error_code();
+  *out = res;
+  return zs_error_none;
+}
+unsigned zs_obj_try_i64(ZsValue obj, long long *out) {
+  if (obj._idx != zs_var_type_object || !obj._v.obj) return zs_error_type;
+  return zs_pyobj_try_i64(static_cast<PyObject *>(obj._v.obj), out);
+}
+unsigned zs_obj_try_f64(ZsValue obj, double *out) {
+  if (obj._idx != zs_var_type_object || !obj._v.obj) return zs_error_type;
+  PyObject *o = static_cast<PyObject *>(obj._v.obj);
+  double res;
+  if (PyFloat_CheckExact(o))
+    res = PyFloat_AS_DOUBLE(o);
+  else if (PyLong_CheckExact(o))
+    res = PyLong_AsDouble(o);
+  else if (auto nb = Py_TYPE(o)->tp_as_number;
+           PyFloat_Check(o) || (nb && (nb->nb_float || nb->nb_index)))
+    res = PyFloat_AsDouble(o);
+  else
+    return zs_error_type;
+  if (res == -1.0 && PyErr_Occurred()) return zs_take_error_code();
+  *out = res;
+  return zs_error_none;
+}
+
 bool ZsValue::isIntegral() const {
   switch (_idx) {
     case zs_var_type_i8:;
@@ -288,6 +381,12 @@ bool ZsValue::isBytes() const {
 bool ZsValue::isByteArray() const {
   return _idx == zs_var_type_object && Py_TYPE(_v.obj) == &PyByteArray_Type;
 }
+bool ZsValue::isBuffer() const {
+  return _idx == zs_var_type_object && PyObject_CheckBuffer(static_cast<PyObject *>(_v.obj));
+}
+bool ZsValue::isIterable() const {
+  return zs_get_obj_features(*this) & zs_obj_feature_iterable;
+}
 bool ZsValue::isString() const {
   return _idx == zs_var_type_object && Py_TYPE(_v.obj) == &PyUnicode_Type;
 }
@@ -301,6 +400,12 @@ bool ZsValue::isSet() const { return _idx == zs_var_type_object && Py_TYPE(_v.ob
 bool ZsValue::isDict() const {
   return _idx == zs_var_type_object && Py_TYPE(_v.obj) == &PyDict_Type;
 }
+bool ZsValue::isPList() const {
+  return _idx == zs_var_type_object && zs_persistent_kind(static_cast<PyObject *>(_v.obj)) == 1;
+}
+bool ZsValue::isPMap() const {
+  return _idx == zs_var_type_object && zs_persistent_kind(static_cast<PyObject *>(_v.obj)) == 2;
+}
 
 /// object
 ZsObject::ZsObject() noexcept {
@@ -324,16 +429,17 @@ void *ZsObject::pytype() const {
   return Py_TYPE(_v.obj);
 }
 zs_obj_type_ ZsObject::type() const { return zs_get_obj_type(*this); }
+void ZsTypedObject::reclassify() noexcept { _objType = zs_classify_obj_type(*this); }
 
 /// module
 const char *ZsModule::name() const {
   if (auto ret = PyModule_GetName(static_cast<PyObject *>(_v.obj))) return ret;
-  PyErr_Print();
+  zs_report_error();
   return nullptr;
 }
 ZsDict ZsModule::dict() {
   if (auto ret = PyModule_GetDict(static_cast<PyObject *>(_v.obj))) return zs_obj(ret);
-  PyErr_Print();
+  zs_report_error();
   return zs_obj(Py_None);
 }
 bool ZsModule::addObject(const char *name, ZsObject obj) {
@@ -343,7 +449,7 @@ bool ZsModule::addObject(const char *name, ZsObject obj) {
       ret == 0) {
     return true;
   }
-  PyErr_Print();
+  zs_report_error();
   return false;
 }
 bool ZsModule::addObjectSteal(const char *name, ZsObject obj) {
@@ -354,7 +460,7 @@ bool ZsModule::addObjectSteal(const char *name, ZsObject obj) {
     return true;
   }
   Py_DECREF(static_cast<PyObject *>(obj.handle()));
-  PyErr_Print();
+  zs_report_error();
   return false;
 }
 bool ZsModule::addStringConstant(const char *name, const char *val) {
@@ -368,13 +474,12 @@ bool ZsModule::addType(ZsObject type) {
 
 /// bytes
 const char *ZsBytes::c_str() const {
-  assert(pytype() == &PyBytes_Type || pytype() == &PyByteArray_Type || _v.obj == Py_None);
+  assert(PyBytes_Check(_v.obj) || PyByteArray_Check(_v.obj) || _v.obj == Py_None);
   const char *ret = nullptr;
   PyObject *pyobj = static_cast<PyObject *>(_v.obj);
-  PyTypeObject *tp = Py_TYPE(pyobj);
-  if (tp == &PyByteArray_Type) {
+  if (PyByteArray_Check(pyobj)) {
     ret = PyByteArray_AsString(pyobj);
-  } else if (tp == &PyBytes_Type) {
+  } else if (PyBytes_Check(pyobj)) {
     /// @note exception only raised upon TypeError, which excluded already
     ret = PyBytes_AsString(pyobj);
   }
@@ -383,8 +488,7 @@ const char *ZsBytes::c_str() const {
 char *ZsBytes::data() {
   char *ret = nullptr;
   PyObject *pyobj = static_cast<PyObject *>(_v.obj);
-  PyTypeObject *tp = Py_TYPE(pyobj);
-  if (tp == &PyByteArray_Type) {
+  if (PyByteArray_Check(pyobj)) {
     ret = PyByteArray_AsString(pyobj);
   }
   return ret;
@@ -392,7 +496,7 @@ char *ZsBytes::data() {
 sint_t ZsBytes::size() const {
   if (isNone())
     return -1;
-  else if (Py_TYPE(_v.obj) == &PyBytes_Type)
+  else if (PyBytes_Check(static_cast<PyObject *>(_v.obj)))
     return PyBytes_Size(static_cast<PyObject *>(_v.obj));
   else
     return PyByteArray_Size(static_cast<PyObject *>(_v.obj));
@@ -400,7 +504,7 @@ sint_t ZsBytes::size() const {
 bool ZsBytes::resize(sint_t sz) {
   PyObject *pyobj = static_cast<PyObject *>(_v.obj);
   if (PyByteArray_Resize(pyobj, sz) != 0) {
-    PyErr_Print();
+    zs_report_error();
     return false;
   }
   return true;
@@ -411,7 +515,7 @@ const char *ZsString::c_str() const {
   assert(pytype() == &PyUnicode_Type || _v.obj == Py_None);
   const char *ret = nullptr;
   if (ret = PyUnicode_AsUTF8AndSize(static_cast<PyObject *>(_v.obj), NULL); ret == NULL)
-    PyErr_Print();
+    zs_report_error();
   return ret;
 }
 
@@ -425,9 +529,17 @@ sint_t ZsTuple::size() const {
 
 ZsObject ZsTuple::operator[](sint_t i) {
   auto ret = PyTuple_GetItem(as_ptr_<PyObject>(*this), i);
-  if (!ret) PyErr_Print();
+  if (!ret) zs_report_error();
   return ret;
 }
+int ZsTuple::setItemSteal(sint_t index, ZsObject item) {
+  if (item._idx == zs_var_type_object) {
+    int ret = PyTuple_SetItem(as_ptr_<PyObject>(*this), index, as_ptr_<PyObject>(item));
+    if (ret == -1) zs_report_error();
+    return ret;
+  }
+  return -1;
+}
 
 /// dict
 sint_t ZsDict::size() const {
@@ -437,18 +549,37 @@ sint_t ZsDict::size() const {
     return PyDict_Size(static_cast<PyObject *>(_v.obj));
 }
 
+/// key
+void *ZsKey::handle() const {
+  if (_obj) return _obj;
+  PyObject *str = PyUnicode_InternFromString(_str);
+  if (!str) {
+    zs_report_error();
+    return nullptr;
+  }
+  Py_hash_t h = PyObject_Hash(str);
+  if (h == -1) {
+    zs_report_error();
+    Py_DECREF(str);
+    return nullptr;
+  }
+  _hash = h;
+  _obj = str;
+  return _obj;
+}
+
 ZsObject ZsDict::operator[](const char *key) {
   PyVar keyStr = PyUnicode_FromString(key);
   auto ret = PyDict_GetItemWithError(as_ptr_<PyObject>(*this), keyStr);
   if (!ret) {
-    if (auto ec = PyErr_Occurred()) PyErr_Print();
+    if (auto ec = PyErr_Occurred()) zs_report_error();
   }
   return ret;
 }
 int ZsDict::set(const char *key, ZsObject item) {
   if (item._idx == zs_var_type_object) {
     int ret = PyDict_SetItemString(as_ptr_<PyObject>(*this), key, as_ptr_<PyObject>(item));
-    if (ret == -1) PyErr_Print();
+    if (ret == -1) zs_report_error();
     return ret;
   }
   return -1;
@@ -457,7 +588,38 @@ int ZsDict::setSteal(const char *key, ZsObject item) {
   if (item._idx == zs_var_type_object) {
     int ret = PyDict_SetItemString(as_ptr_<PyObject>(*this), key, as_ptr_<PyObject>(item));
     if (ret == -1)
-      PyErr_Print();
+      zs_report_error();
+    else
+      Py_DECREF(item.handle());
+    return ret;
+  }
+  return -1;
+}
+
+ZsObject ZsDict::operator[](const ZsKey &key) {
+  PyObject *keyStr = static_cast<PyObject *>(key.handle());
+  if (!keyStr) return {};
+  auto ret = PyDict_GetItemWithError(as_ptr_<PyObject>(*this), keyStr);
+  if (!ret) {
+    if (PyErr_Occurred()) zs_report_error();
+  }
+  return ret;
+}
+int ZsDict::set(const ZsKey &key, ZsObject item) {
+  PyObject *keyStr = static_cast<PyObject *>(key.handle());
+  if (keyStr && item._idx == zs_var_type_object) {
+    int ret = PyDict_SetItem(as_ptr_<PyObject>(*this), keyStr, as_ptr_<PyObject>(item));
+    if (ret == -1) zs_report_error();
+    return ret;
+  }
+  return -1;
+}
+int ZsDict::setSteal(const ZsKey &key, ZsObject item) {
+  PyObject *keyStr = static_cast<PyObject *>(key.handle());
+  if (keyStr && item._idx == zs_var_type_object) {
+    int ret = PyDict_SetItem(as_ptr_<PyObject>(*this), keyStr, as_ptr_<PyObject>(item));
+    if (ret == -1)
+      zs_report_error();
     else
       Py_DECREF(item.handle());
     return ret;
@@ -489,13 +651,13 @@ sint_t ZsList::size() const {
 
 ZsObject ZsList::operator[](sint_t i) {
   auto ret = PyList_GetItem(as_ptr_<PyObject>(*this), i);
-  if (!ret) PyErr_Print();
+  if (!ret) zs_report_error();
   return ret;
 }
 int ZsList::setItemSteal(sint_t index, ZsObject item) {
   if (item._idx == zs_var_type_object) {
     int ret = PyList_SetItem(as_ptr_<PyObject>(*this), index, as_ptr_<PyObject>(item));
-    if (ret == -1) PyErr_Print();
+    if (ret == -1) zs_report_error();
     return ret;
   }
   return -1;
@@ -503,7 +665,7 @@ int ZsList::setItemSteal(sint_t index, ZsObject item) {
 int ZsList::insert(sint_t index, ZsObject item) {
   if (item._idx == zs_var_type_object) {
     int ret = PyList_Insert(as_ptr_<PyObject>(*this), index, as_ptr_<PyObject>(item));
-    if (ret == -1) PyErr_Print();
+    if (ret == -1) zs_report_error();
     return ret;
   }
   return -1;
@@ -511,7 +673,7 @@ int ZsList::insert(sint_t index, ZsObject item) {
 int ZsList::append(ZsObject item) {
   if (item._idx == zs_var_type_object) {
     int ret = PyList_Append(as_ptr_<PyObject>(*this), as_ptr_<PyObject>(item));
-    if (ret == -1) PyErr_Print();
+    if (ret == -1) zs_report_error();
     return ret;
   }
   return -1;
@@ -520,7 +682,7 @@ int ZsList::insertSteal(sint_t index, ZsObject item) {
   if (item._idx == zs_var_type_object) {
     int ret = PyList_Insert(as_ptr_<PyObject>(*this), index, as_ptr_<PyObject>(item));
     if (ret == -1)
-      PyErr_Print();
+      zs_report_error();
     else
       Py_DECREF(item.handle());
     return ret;
@@ -531,7 +693,7 @@ int ZsList::appendSteal(ZsObject item) {
   if (item._idx == zs_var_type_object) {
     int ret = PyList_Append(as_ptr_<PyObject>(*this), as_ptr_<PyObject>(item));
     if (ret == -1)
-      PyErr_Print();
+      zs_report_error();
     else
       Py_DECREF(item.handle());
     return ret;
@@ -554,10 +716,10 @@ ZsSet::Iterator::Iterator(ZsSet set)
     _item._v.obj = PyIter_Next(as_ptr_<PyObject>(_it));
     if (!_item._v.obj) {
       _item._v.obj = Py_None;
-      if (PyErr_Occurred()) PyErr_Print();
+      if (PyErr_Occurred()) zs_report_error();
     }
   } else
-    PyErr_Print();
+    zs_report_error();
 }
 ZsSet::Iterator::~Iterator() {
   if (_item) {
@@ -572,13 +734,84 @@ ZsSet::Iterator &ZsSet::Iterator::operator++() {
     _item._v.obj = PyIter_Next(as_ptr_<PyObject>(_it));
     if (!_item._v.obj) {
       _item._v.obj = Py_None;
-      if (PyErr_Occurred()) PyErr_Print();
+      if (PyErr_Occurred()) zs_report_error();
       _valid = 0;
     }
   }
   return *this;
 }
 
+/// persistent list
+ZsObject ZsPList::operator[](sint_t i) {
+  auto ret = zs_persistent_list_get(as_ptr_<PyObject>(*this), i);
+  if (!ret) zs_report_error();
+  return ret;
+}
+sint_t ZsPList::size() const {
+  if (isNone())
+    return -1;
+  else
+    return zs_persistent_list_size(static_cast<PyObject *>(_v.obj));
+}
+static ZsValuePort zs_persistent_version(PyObject *ret) {
+  if (ret) return zs_obj(ret);
+  zs_report_error();
+  return zs_obj(Py_None);
+}
+ZsValuePort ZsPList::set(sint_t i, ZsObject item) const {
+  return zs_persistent_version(
+      zs_persistent_list_set(as_ptr_<PyObject>(*this), i, as_ptr_<PyObject>(item)));
+}
+ZsValuePort ZsPList::append(ZsObject item) const {
+  return zs_persistent_version(
+      zs_persistent_list_append(as_ptr_<PyObject>(*this), as_ptr_<PyObject>(item)));
+}
+ZsValuePort ZsPList::pop() const {
+  return zs_persistent_version(zs_persistent_list_pop(as_ptr_<PyObject>(*this)));
+}
+
+/// persistent map
+ZsObject ZsPMap::operator[](const char *key) {
+  PyVar keyStr = PyUnicode_FromString(key);
+  if (!keyStr) {
+    zs_report_error();
+    return ZsObject{};
+  }
+  return at(keyStr.getValue());
+}
+ZsObject ZsPMap::at(ZsObject key) {
+  auto ret = zs_persistent_map_get(as_ptr_<PyObject>(*this), as_ptr_<PyObject>(key));
+  if (!ret && PyErr_Occurred()) zs_report_error();
+  return ret;
+}
+sint_t ZsPMap::size() const {
+  if (isNone())
+    return -1;
+  else
+    return zs_persistent_map_size(static_cast<PyObject *>(_v.obj));
+}
+ZsValuePort ZsPMap::set(const char *key, ZsObject item) const {
+  PyVar keyStr = PyUnicode_FromString(key);
+  if (!keyStr) return zs_persistent_version(nullptr);
+  return set(keyStr.getValue(), item);
+}
+ZsValuePort ZsPMap::set(ZsObject key, ZsObject item) const {
+  return zs_persistent_version(zs_persistent_map_set(
+      as_ptr_<PyObject>(*this), as_ptr_<PyObject>(key), as_ptr_<PyObject>(item)));
+}
+ZsValuePort ZsPMap::erase(const char *key) const {
+  PyVar keyStr = PyUnicode_FromString(key);
+  if (!keyStr) return zs_persistent_version(nullptr);
+  return erase(keyStr.getValue());
+}
+ZsValuePort ZsPMap::erase(ZsObject key) const {
+  return zs_persistent_version(
+      zs_persistent_map_remove(as_ptr_<PyObject>(*this), as_ptr_<PyObject>(key)));
+}
+ZsValuePort ZsPMap::items() const {
+  return zs_persistent_version(zs_persistent_map_items(as_ptr_<PyObject>(*this)));
+}
+
 #ifdef __cplusplus
 }
 #endif
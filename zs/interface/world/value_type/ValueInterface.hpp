@@ -1,6 +1,11 @@
 #pragma once
 #include "interface/InterfaceExport.hpp"
 
+#ifdef __cplusplus
+#  include <limits>
+#  include <type_traits>
+#endif
+
 using sint_t = long long int;
 
 #ifdef __cplusplus
@@ -12,7 +17,8 @@ struct PyVar;
 /**
   @brief These are the most frequently-used official python object types (long, float, tuple, list,
   set, dict, etc.), other types including user-defined type extensions are recognized as
-  **zs_obj_type_custom**
+  **zs_obj_type_custom**, except for buffer exporters and persistent containers, which have their
+  own kinds appended after it
  */
 enum zs_obj_type_ : unsigned {
   zs_obj_type_bytes,
@@ -27,6 +33,9 @@ enum zs_obj_type_ : unsigned {
   zs_obj_type_module,
   zs_obj_type_num_inherent,
   zs_obj_type_custom,
+  zs_obj_type_buffer,  // any other object exporting the buffer protocol (memoryview, array, ...)
+  zs_obj_type_plist,   // zs.PersistentList
+  zs_obj_type_pmap,    // zs.PersistentMap
   zs_obj_type_unknown = ~((unsigned)0)  // not an obj
 };
 enum zs_obj_feature_ : unsigned {  // mainly used for custom object types
@@ -64,6 +73,8 @@ struct ZsTuple;
 struct ZsList;
 struct ZsSet;
 struct ZsDict;
+struct ZsPList;
+struct ZsPMap;
 
 /// @note _idx of zs_var_type_object with an empty obj (i.e. nullptr) is
 /// INVALID!
@@ -146,6 +157,12 @@ struct ZS_INTERFACE_EXPORT ZsValue : ZsValuePort {  // behave like a handle
   bool isByteArray() const;
   /// @brief check if value type is python **bytes** or **bytearray**
   bool isBytesOrByteArray() const { return isBytes() || isByteArray(); }
+  /// @brief check if value type is a python object supporting the buffer protocol (including
+  /// **bytes** and **bytearray**), see ZsBuffer
+  bool isBuffer() const;
+  /// @brief check if value type is an iterable python object (builtin or custom), i.e. it has
+  /// **zs_obj_feature_iterable**, see ZsChunkIterator
+  bool isIterable() const;
   /// @brief check if value type is python **str** (unicode)
   bool isString() const;
   /// @brief check if value type is python **tuple**
@@ -156,6 +173,10 @@ struct ZS_INTERFACE_EXPORT ZsValue : ZsValuePort {  // behave like a handle
   bool isSet() const;
   /// @brief check if value type is python **dict**
   bool isDict() const;
+  /// @brief check if value type is a persistent list (**zs.PersistentList**)
+  bool isPList() const;
+  /// @brief check if value type is a persistent map (**zs.PersistentMap**)
+  bool isPMap() const;
   /// @brief check if value type is not none (i.e. !isNone())
   operator bool() const { return !isNone(); }
 
@@ -171,6 +192,8 @@ struct ZS_INTERFACE_EXPORT ZsValue : ZsValuePort {  // behave like a handle
   ZS_VALUE_DECLARE_OBJECT_REF(Dict)
   ZS_VALUE_DECLARE_OBJECT_REF(List)
   ZS_VALUE_DECLARE_OBJECT_REF(Set)
+  ZS_VALUE_DECLARE_OBJECT_REF(PList)
+  ZS_VALUE_DECLARE_OBJECT_REF(PMap)
 #undef ZS_VALUE_DECLARE_OBJECT_REF
 };
 
@@ -246,6 +269,8 @@ struct ZS_INTERFACE_EXPORT ZsTuple : ZsObject {
   ZS_OBJECT_CONSTRUCTION_DEF(Tuple)
 
   ZsObject operator[](sint_t i);
+  /// @brief fill the slot \a index of a newly built tuple, stealing \a item
+  int setItemSteal(sint_t index, ZsObject item);
 
   /**
     @brief iterator for ZsTuple
@@ -316,6 +341,34 @@ struct ZS_INTERFACE_EXPORT ZsTuple : ZsObject {
 
   sint_t size() const;
 };
+/**
+  @brief an interned python **str** key with its hash cached, for repeated dict/attribute lookups
+
+  A ZsKey is constant-initialized from a string literal, thus is safe to define at namespace
+  scope before the python interpreter is up. The interned **str** is created (and hashed) once on
+  first use, later lookups neither allocate nor rehash.
+  \code
+static ZsKey k_pos{"pos"};
+ZsObject pos = dict[k_pos];
+  \endcode
+  @note the referenced string must outlive the key. The interned object is intentionally never
+  released. First use requires GIL.
+ */
+struct ZS_INTERFACE_EXPORT ZsKey {
+  constexpr ZsKey(const char *literal) noexcept : _str{literal}, _obj{nullptr}, _hash{-1} {}
+  ZsKey(const ZsKey &) = delete;
+  ZsKey &operator=(const ZsKey &) = delete;
+
+  const char *c_str() const noexcept { return _str; }
+  /// @brief the interned **str** (borrowed), nullptr if its creation failed
+  void *handle() const;
+  /// @brief the cached hash of the key, -1 if its creation failed
+  sint_t hash() const { return handle() ? _hash : -1; }
+
+  const char *_str;
+  mutable void *_obj;
+  mutable sint_t _hash;
+};
 /**
   @brief holds a PyDict_Type object or Py_None
 
@@ -335,7 +388,9 @@ struct ZS_INTERFACE_EXPORT ZsDict : ZsObject {
   ZS_OBJECT_CONSTRUCTION_DEF(Dict)
 
   ZsObject operator[](const char *key);
+  ZsObject operator[](const ZsKey &key);
   ZsObject at(const char *key) { return operator[](key); }
+  ZsObject at(const ZsKey &key) { return operator[](key); }
 
   /// @note non-standard iterator
   struct ZS_INTERFACE_EXPORT Iterator {
@@ -366,7 +421,9 @@ struct ZS_INTERFACE_EXPORT ZsDict : ZsObject {
   };
   Iterator begin() { return Iterator(*this); }
   int set(const char *key, ZsObject item);
+  int set(const ZsKey &key, ZsObject item);
   int setSteal(const char *key, ZsObject item);
+  int setSteal(const ZsKey &key, ZsObject item);
   sint_t size() const;
 };
 /**
@@ -495,6 +552,89 @@ struct ZS_INTERFACE_EXPORT ZsSet : ZsObject {
   Iterator begin() { return Iterator(*this); }
   sint_t size() const;
 };
+/**
+  @brief holds a zs.PersistentList object or Py_None
+
+  An immutable list, updates return new versions (new references, None on failure) sharing
+  structure with the original, which is left untouched.
+  \code
+PyVar v2 = l.append(item);  // l is unchanged
+PyVar v3 = v2.getValue().asPList().set(0, other);
+  \endcode
+ */
+struct ZS_INTERFACE_EXPORT ZsPList : ZsObject {
+  ZS_OBJECT_CONSTRUCTION_DEF(PList)
+
+  /// @note borrowed reference
+  ZsObject operator[](sint_t i);
+  sint_t size() const;
+
+  ZsValuePort set(sint_t i, ZsObject item) const;
+  ZsValuePort append(ZsObject item) const;
+  ZsValuePort pop() const;
+};
+/**
+  @brief holds a zs.PersistentMap object or Py_None
+
+  An immutable hash map, updates return new versions (new references, None on failure) sharing
+  structure with the original, which is left untouched.
+ */
+struct ZS_INTERFACE_EXPORT ZsPMap : ZsObject {
+  ZS_OBJECT_CONSTRUCTION_DEF(PMap)
+
+  /// @note borrowed reference, Py_None if missing
+  ZsObject operator[](const char *key);
+  ZsObject at(const char *key) { return operator[](key); }
+  ZsObject at(ZsObject key);
+  sint_t size() const;
+
+  ZsValuePort set(const char *key, ZsObject item) const;
+  ZsValuePort set(ZsObject key, ZsObject item) const;
+  /// @note the map itself (a new reference) if \a key is missing
+  ZsValuePort erase(const char *key) const;
+  ZsValuePort erase(ZsObject key) const;
+  /// @brief return a python **list** of (key, value) tuples
+  ZsValuePort items() const;
+};
+
+/**
+  @brief a ZsObject handle carrying its zs_obj_type_, classified once (see zs_classify_obj_type)
+  Type queries are inline comparisons afterwards, e.g. when dispatching over many pins in a loop.
+  Unlike the ones of ZsValue, these queries include subclasses.
+  \code
+ZsTypedObject o = value;
+if (o.isList()) {
+  ZsList &l = o.asList();
+}
+  \endcode
+  @note the classification is a snapshot, call reclassify() once the handle is re-assigned
+ */
+struct ZS_INTERFACE_EXPORT ZsTypedObject : ZsObject {
+  ZsTypedObject() noexcept : ZsObject{} { reclassify(); }
+  ZsTypedObject(ZsValue handle) noexcept : ZsObject{handle} { reclassify(); }
+  ZsTypedObject(ZsValuePort handle) noexcept : ZsObject{handle} { reclassify(); }
+  ZsTypedObject(ZsObject handle) noexcept : ZsObject{handle} { reclassify(); }
+  ZsTypedObject(void *obj) noexcept : ZsObject{obj} { reclassify(); }
+
+  void reclassify() noexcept;
+  zs_obj_type_ type() const noexcept { return _objType; }
+
+  bool isBytes() const noexcept { return _objType == zs_obj_type_bytes; }
+  bool isByteArray() const noexcept { return _objType == zs_obj_type_bytearray; }
+  bool isBytesOrByteArray() const noexcept { return isBytes() || isByteArray(); }
+  bool isString() const noexcept { return _objType == zs_obj_type_string; }
+  bool isTuple() const noexcept { return _objType == zs_obj_type_tuple; }
+  bool isLong() const noexcept { return _objType == zs_obj_type_long; }
+  bool isFloat() const noexcept { return _objType == zs_obj_type_float; }
+  bool isList() const noexcept { return _objType == zs_obj_type_list; }
+  bool isSet() const noexcept { return _objType == zs_obj_type_set; }
+  bool isDict() const noexcept { return _objType == zs_obj_type_dict; }
+  bool isModule() const noexcept { return _objType == zs_obj_type_module; }
+  bool isPList() const noexcept { return _objType == zs_obj_type_plist; }
+  bool isPMap() const noexcept { return _objType == zs_obj_type_pmap; }
+
+  zs_obj_type_ _objType;
+};
 
 #define ZS_VALUE_DEF_OBJECT_REF(TYPE)                                      \
   Zs##TYPE &ZsValue::as##TYPE() { return static_cast<Zs##TYPE &>(*this); } \
@@ -507,25 +647,383 @@ ZS_VALUE_DEF_OBJECT_REF(Tuple)
 ZS_VALUE_DEF_OBJECT_REF(Dict)
 ZS_VALUE_DEF_OBJECT_REF(List)
 ZS_VALUE_DEF_OBJECT_REF(Set)
+ZS_VALUE_DEF_OBJECT_REF(PList)
+ZS_VALUE_DEF_OBJECT_REF(PMap)
 #undef ZS_VALUE_DEF_OBJECT_REF
 
 /**
   @}
   */
 
+/// interpreter lifetime
+/**
+  @brief Interpreter startup settings, see PyPreConfig/PyConfig
+  Python is initialized on demand: either explicitly through zs_initialize, or with the defaults
+  on first use (any world api, object builders, GILGuard). Nothing happens when the library is
+  loaded. In both cases the initializing thread keeps the GIL as with Py_Initialize, unless
+  releaseGIL is set, thus hosts touching python first from a thread other than the one driving
+  the world should call zs_initialize with releaseGIL.
+ */
+struct ZsInterpreterConfig {
+  int isolated;               // PyConfig_InitIsolatedConfig instead of PyConfig_InitPythonConfig
+  int utf8Mode;               // -1: python default
+  int installSignalHandlers;  // python default: 1
+  int siteImport;             // import site, python default: 1
+  /// give up the GIL once initialized. Otherwise (as Py_Initialize) the initializing thread keeps
+  /// it, the default also used by on-first-use initialization.
+  int releaseGIL;
+  int verbose;              // report the appended module path
+  const char *home;         // NULL: python default
+  const char *programName;  // NULL: python default
+};
+ZS_INTERFACE_EXPORT void zs_interpreter_config_init(ZsInterpreterConfig *config);
+/// @brief initialize python with \a config (NULL: defaults), no-op if already initialized
+/// @note if the host initialized python itself, only the world is bootstrapped
+ZS_INTERFACE_EXPORT bool zs_initialize(const ZsInterpreterConfig *config = nullptr);
+ZS_INTERFACE_EXPORT bool zs_is_initialized();
+/// @brief startup breakdown in milliseconds, 0 for phases skipped
+struct ZsStartupTimings {
+  double preinitialize;  // Py_PreInitialize
+  double initialize;     // Py_InitializeFromConfig
+  double modulePath;     // locating the library to extend sys.path
+  double bootstrap;      // world bootstrap script
+  double outputSinks;    // sys.stdout/sys.stderr redirection
+  double total;
+};
+ZS_INTERFACE_EXPORT void zs_startup_timings(ZsStartupTimings *timings);
+
+/// @brief error codes of zs_last_error, classified by the python exception type
+enum zs_error_ : unsigned {
+  zs_error_none = 0,
+  zs_error_exception,  // any other exception
+  zs_error_type,
+  zs_error_value,
+  zs_error_key,
+  zs_error_index,
+  zs_error_attribute,
+  zs_error_overflow,
+  zs_error_zero_division,
+  zs_error_memory,
+  zs_error_stop_iteration,
+  zs_error_system_exit,
+  zs_error_num
+};
+
 /// states
+/// @brief query (and reset to zs_error_none) the code of the last failure on the calling thread
 ZS_INTERFACE_EXPORT unsigned zs_last_error();
 ZS_INTERFACE_EXPORT unsigned zs_last_warn();
+/// @brief convert the python object held by \a obj into \a out without reporting any error
+/// @return zs_error_none on success, otherwise the zs_error_ code (e.g. **zs_error_type** if the
+/// object is not an integer, **zs_error_overflow**), \a out being untouched
+/// @note exact int/float objects take a fast path, see also zs::try_get
+ZS_INTERFACE_EXPORT unsigned zs_obj_try_i64(ZsValue obj, long long *out);
+ZS_INTERFACE_EXPORT unsigned zs_obj_try_f64(ZsValue obj, double *out);
+/// @brief "ExceptionType: message" of the last failure on the calling thread, "" if none
+/// @note formatted on first request, valid until the next failure on this thread. GIL required.
+ZS_INTERFACE_EXPORT const char *zs_last_error_message();
+/// @brief the python exception type (borrowed) of the last failure on the calling thread, or None
+ZS_INTERFACE_EXPORT ZsValuePort zs_last_error_type();
+/// @brief drop the last failure record of the calling thread (GIL required)
+ZS_INTERFACE_EXPORT void zs_clear_error();
+/// @brief enter/leave the quiet error mode of the calling thread (nestable), in which failures are
+/// only recorded (see zs_last_error) instead of printed with their traceback
+ZS_INTERFACE_EXPORT void zs_quiet_errors_push();
+ZS_INTERFACE_EXPORT void zs_quiet_errors_pop();
+ZS_INTERFACE_EXPORT bool zs_quiet_errors();
+/**
+  @brief RAII scope of the quiet error mode, e.g. around hot loops probing conversions
+  \code
+ZsQuietErrors quiet;
+for (auto item : list) {
+  double v = (double)ZsValue{zs_float_obj_str(item)};
+  if (zs_last_error() != zs_error_none) continue;  // e.g. zs_error_value, nothing printed
+}
+  \endcode
+ */
+struct ZsQuietErrors {
+  ZsQuietErrors() { zs_quiet_errors_push(); }
+  ~ZsQuietErrors() { zs_quiet_errors_pop(); }
+  ZsQuietErrors(const ZsQuietErrors &) = delete;
+  ZsQuietErrors &operator=(const ZsQuietErrors &) = delete;
+};
 ZS_INTERFACE_EXPORT ZsValuePort zs_world_handle();        // global dict
 ZS_INTERFACE_EXPORT ZsValuePort zs_world_local_handle();  // local dict
 ZS_INTERFACE_EXPORT bool zs_world_pending_input();
+
+/// @brief captured python output streams
+enum zs_output_stream_ : unsigned {
+  zs_output_stream_stdout = 1,
+  zs_output_stream_stderr = 2,
+};
+/**
+  @brief zero-copy view of the captured (not yet consumed) output of \a stream
+  @note sys.stdout/sys.stderr are redirected into bounded ring buffers, thus the bytes are exposed
+  as two consecutive spans ([\a first, \a first + \a firstLen) then [\a second, \a second +
+  \a secondLen)). The view stays valid until python writes again, hold the GIL while reading it.
+  @return total number of viewed bytes, -1 if \a stream is invalid
+ */
+ZS_INTERFACE_EXPORT sint_t zs_world_output_view(zs_output_stream_ stream, const char **first,
+                                                sint_t *firstLen, const char **second,
+                                                sint_t *secondLen);
+/// @brief discard the oldest \a numBytes captured bytes of \a stream (after reading them)
+ZS_INTERFACE_EXPORT void zs_world_output_consume(zs_output_stream_ stream, sint_t numBytes);
+/// @brief number of bytes of \a stream dropped so far, because either the capture ring buffer or
+/// the non-blocking streaming queue was full
+ZS_INTERFACE_EXPORT unsigned long long zs_world_output_dropped(zs_output_stream_ stream);
+/// @brief bound each captured output stream to \a numBytes (1 MiB by default)
+/// @note discards the currently captured output
+ZS_INTERFACE_EXPORT void zs_world_set_output_limit(unsigned long long numBytes);
+
+/**
+  @brief receives python output chunks of \a stream as soon as they are written
+  @note invoked on the python thread with the GIL held, the script blocks until it returns
+ */
+typedef void (*zs_output_callback_t)(zs_output_stream_ stream, const char *data, sint_t len,
+                                     void *userData);
+/// @brief stream python output to \a callback while scripts are running (NULL to stop streaming)
+/// @note stdout delivered to the callback is not returned by zs_execute_script/statement, while
+/// the stderr text of a failed execution still is (as a copy)
+ZS_INTERFACE_EXPORT void zs_world_set_output_callback(zs_output_callback_t callback,
+                                                      void *userData);
+/**
+  @brief stream python output through lock-free queues (one per stream) of \a capacity bytes
+  (0 disables), polled with zs_world_poll_output
+  @param blockWhenFull if true, python waits (with the GIL released) for the consumer to make
+  room, otherwise the overflowing bytes are dropped (see zs_world_output_dropped)
+  @note the registered output callback, if any, takes precedence
+  @note the stderr text of a failed zs_execute_script/statement is also returned (as a copy)
+  @note must not be called while another thread is polling
+ */
+ZS_INTERFACE_EXPORT void zs_world_enable_output_stream(unsigned long long capacity,
+                                                       bool blockWhenFull = true);
+/// @brief pop at most \a capacity streamed bytes of \a stream into \a dst, without the GIL
+/// @note only a single consumer thread is supported
+/// @return number of bytes popped, -1 if \a stream is invalid
+ZS_INTERFACE_EXPORT sint_t zs_world_poll_output(zs_output_stream_ stream, char *dst,
+                                                sint_t capacity);
 ZS_INTERFACE_EXPORT void *zs_execute_statement(const char *cmd, int *result);
+/**
+  @brief How zs_eval_expr isolates expressions from the world (global dict)
+ */
+enum zs_eval_namespace_ : unsigned {
+  /// evaluate against a small per-call locals dict layered over the shared global dict. Stores land
+  /// in the locals, expressions that could reach the global dict itself (globals(), exec, eval,
+  /// __globals__, f_globals, getattr, vars, frames, global stores in nested scopes) still get a
+  /// private copy. The check is a static scan of the names used by the expression, it guards
+  /// against accidental rebinding rather than deliberately obfuscated access (use
+  /// zs_eval_namespace_copy for untrusted expressions).
+  zs_eval_namespace_overlay = 0,
+  /// always evaluate against a private copy of the global dict, O(size of globals) per call
+  zs_eval_namespace_copy
+};
+ZS_INTERFACE_EXPORT void zs_set_eval_namespace(zs_eval_namespace_ mode);
+ZS_INTERFACE_EXPORT zs_eval_namespace_ zs_get_eval_namespace();
 ZS_INTERFACE_EXPORT void *zs_eval_expr(const char *expr, void **errLogBytes = nullptr);
+/// @brief evaluate \a expr with per-call variable \a bindings (a python dict or none)
+/// @note \a bindings shadow the names of the world, and is never modified by the evaluation
+ZS_INTERFACE_EXPORT void *zs_eval_expr_with_bindings(const char *expr, ZsValue bindings,
+                                                     void **errLogBytes = nullptr);
+/**
+  @brief evaluate \a count expressions under a single GIL acquisition
+  @param exprs \a count NULL-terminated expressions
+  @param bindings NULL, or \a count per-expression bindings (python dict or none), see
+  zs_eval_expr_with_bindings
+  @param results receives \a count values. A python int (fits in i64) or float result is returned
+  as a native zs_var_type_i64 / zs_var_type_f64 value, any other result as a new reference of a
+  python object, and failures as zs_var_type_none.
+  @param states NULL, or receives \a count states (-1: empty expression, 0: success, 1: compilation
+  error, 2: evaluation error, 3: invalid bindings, 5: request exit)
+  @param errLogBytes NULL, or receives \a count error messages (python bytes or NULL). Leave it NULL
+  to skip formatting error messages.
+  @return the number of successfully evaluated expressions
+ */
+ZS_INTERFACE_EXPORT sint_t zs_eval_expr_batch(const char *const *exprs, sint_t count,
+                                              const ZsValuePort *bindings, ZsValuePort *results,
+                                              int *states, void **errLogBytes = nullptr);
 ZS_INTERFACE_EXPORT void *zs_execute_script(const char *cmd, int *state);
 
+/**
+  @brief Asynchronous execution on a dedicated interpreter thread
+  Jobs run one at a time in submission order. The submitting thread returns immediately with a
+  job handle (0 on failure), which stays valid until zs_job_release.
+  @note the first submission from the thread that initialized python makes it give up the GIL, so
+  python api has to be accessed through GILGuard from then on
+  @note do not submit while holding a GILGuard: a job only starts once the submitting thread lets go
+  of the GIL (zs_job_wait releases it while waiting)
+ */
+typedef unsigned long long ZsJobHandle;
+enum zs_job_status_ : int {
+  zs_job_status_invalid = -1,
+  zs_job_status_queued = 0,
+  zs_job_status_running,
+  zs_job_status_finished,
+  zs_job_status_cancelled
+};
+/// @brief invoked once the job is finished or cancelled
+/// @note invoked on the interpreter thread (or the cancelling thread), without the GIL
+typedef void (*zs_job_callback_t)(ZsJobHandle job, void *userData);
+/// @brief zs_execute_script on the interpreter thread,  cmd is copied
+ZS_INTERFACE_EXPORT ZsJobHandle zs_execute_script_async(const char *cmd,
+                                                        zs_job_callback_t callback = nullptr,
+                                                        void *userData = nullptr);
+/// @brief zs_eval_expr on the interpreter thread,  expr is copied
+ZS_INTERFACE_EXPORT ZsJobHandle zs_eval_expr_async(const char *expr,
+                                                   zs_job_callback_t callback = nullptr,
+                                                   void *userData = nullptr);
+ZS_INTERFACE_EXPORT zs_job_status_ zs_job_status(ZsJobHandle job);
+/// @brief block until \a job is finished or cancelled, or \a timeoutMs (negative: no limit) passed
+/// @note the GIL held by the calling thread (if any) is released meanwhile
+/// @return the status of \a job by then
+ZS_INTERFACE_EXPORT zs_job_status_ zs_job_wait(ZsJobHandle job, long long timeoutMs = -1);
+/// @brief drop a queued job, or interrupt a running one by raising KeyboardInterrupt in it
+/// @note a running job is only interrupted once it executes python bytecode again
+/// @return false if \a job is already done or invalid
+ZS_INTERFACE_EXPORT bool zs_job_cancel(ZsJobHandle job);
+/**
+  @brief take the result of a finished job, as its synchronous counterpart returns it
+  @param state receives the state of zs_execute_script. For zs_eval_expr_async, 0 on success and 2
+  on failure. -1 if \a job is not finished (yet).
+  @note ownership of the returned objects is transferred to the caller, subsequent calls return NULL
+ */
+ZS_INTERFACE_EXPORT void *zs_job_result(ZsJobHandle job, int *state,
+                                        void **errLogBytes = nullptr);
+/// @brief invalidate \a job and drop its results not taken yet, the job itself is not cancelled
+ZS_INTERFACE_EXPORT void zs_job_release(ZsJobHandle job);
+
+/**
+  @brief Native payload moved between (sub-)interpreters, python objects can not cross them
+  As an input, \a name is the variable it is bound to and the data is borrowed. As an output, the
+  data is owned by the payload and freed through zs_payload_release.
+ */
+enum zs_payload_type_ : int {
+  zs_payload_none = 0,
+  zs_payload_i64,
+  zs_payload_f64,
+  zs_payload_bytes,      // python bytes
+  zs_payload_i64_array,  // python memoryview of format 'q'
+  zs_payload_f64_array   // python memoryview of format 'd'
+};
+struct ZsPayload {
+  const char *name;
+  zs_payload_type_ type;
+  union {
+    long long i64;
+    double f64;
+  } v;
+  void *data;  // bytes and arrays
+  sint_t len;  // number of bytes, or number of array elements
+};
+ZS_INTERFACE_EXPORT void zs_payload_release(ZsPayload *payload);
+/// @brief convert \a payload into a python object of the current interpreter
+/// @note GIL must be held
+ZS_INTERFACE_EXPORT ZsValuePort zs_payload_to_obj(const ZsPayload *payload);
+/**
+  @brief convert \a obj of the current interpreter into \a payload
+  int, float, None, bytes/bytearray, str (utf-8 bytes) and contiguous buffers of 8-byte integers or
+  doubles are supported
+  @note GIL must be held
+  @return false if \a obj is not representable
+ */
+ZS_INTERFACE_EXPORT bool zs_payload_from_obj(ZsValue obj, ZsPayload *payload);
+
+/**
+  @brief Pool of isolated sub-interpreters, each with its own GIL (python 3.12+ only)
+  Every interpreter runs on its own thread and starts from its own copy of the bootstrap world.
+  Host threads submitting to the pool concurrently are served in parallel, by whichever
+  interpreter is free.
+  @note extension modules not supporting multiple interpreters (e.g. numpy) fail to import there
+  @note ZsKey, ZsAttrHandle, zs_buffer_obj_external and ZsPList/ZsPMap cache python objects of the
+  main interpreter process-wide, pooled scripts must not use them
+  @note the GIL held by the calling thread (if any) is released while starting or stopping
+  @return the number of interpreters running, 0 if not supported
+ */
+ZS_INTERFACE_EXPORT sint_t zs_interp_pool_start(sint_t numInterpreters);
+ZS_INTERFACE_EXPORT void zs_interp_pool_stop();
+ZS_INTERFACE_EXPORT sint_t zs_interp_pool_size();
+/**
+  @brief evaluate \a expr on a free pooled interpreter with \a inputs bound, blocks until done
+  @param result receives the value of \a expr, see zs_payload_from_obj
+  @param errLog NULL, or receives the error message as zs_payload_bytes on failure
+  @return -1: empty expression, 0: success, 1: compilation error, 2: evaluation error, 3: inputs
+  or result not representable, 4: pool not running, 5: request exit
+ */
+ZS_INTERFACE_EXPORT int zs_interp_pool_eval_expr(const char *expr, const ZsPayload *inputs,
+                                                 sint_t numInputs, ZsPayload *result,
+                                                 ZsPayload *errLog = nullptr);
+/**
+  @brief execute \a cmd on a free pooled interpreter with \a inputs bound, blocks until done
+  Each script runs in a fresh copy of the interpreter's world, nothing is kept between scripts.
+  @param result NULL, or receives the value the script assigns to 'zs_result' (none otherwise)
+  @param output NULL, or receives the captured stdout on success, stderr otherwise
+  @return -1: empty script, 0: success, 1: execution error, 2: compilation error (as
+  zs_execute_script), 3: zs_result not representable as a payload, 4: pool not running, 5:
+  request exit
+ */
+ZS_INTERFACE_EXPORT int zs_interp_pool_execute_script(const char *cmd, const ZsPayload *inputs,
+                                                      sint_t numInputs, ZsPayload *result,
+                                                      ZsPayload *output = nullptr);
+
+/// @brief statistics of the compiled-code cache shared by zs_eval_expr, zs_execute_script and
+/// zs_execute_statement
+struct ZsCodeCacheStats {
+  unsigned long long hits;
+  unsigned long long misses;
+  unsigned long long evictions;
+  unsigned long long size;
+  unsigned long long capacity;
+};
+ZS_INTERFACE_EXPORT void zs_code_cache_stats(ZsCodeCacheStats *stats);
+/// @brief bound the number of cached code objects, 0 disables caching
+ZS_INTERFACE_EXPORT void zs_code_cache_set_capacity(unsigned long long capacity);
+ZS_INTERFACE_EXPORT void zs_code_cache_clear();
+/**
+  @brief persist scripts compiled for zs_execute_script under \a directory (created if missing), so
+  that later runs of any process skip compilation. NULL or "" disables it (default).
+  @note entries are keyed by content and checked against the interpreter version, the directory can
+  be shared by concurrent processes
+ */
+ZS_INTERFACE_EXPORT bool zs_bytecode_cache_set_directory(const char *directory);
+struct ZsBytecodeCacheStats {
+  unsigned long long hits;
+  unsigned long long misses;
+  unsigned long long writes;
+  unsigned long long rejected;  // stale or invalid entries, also counted as misses
+};
+ZS_INTERFACE_EXPORT void zs_bytecode_cache_stats(ZsBytecodeCacheStats *stats);
+
+/**
+  @brief give the calling thread a persistent python thread state, reused by every GILGuard
+  (PyGILState_Ensure) on it instead of creating and destroying one each time
+  @note idempotent, the GIL is not held afterwards (unless it was before). The thread state is
+  released by zs_unregister_worker_thread, or when the thread exits.
+ */
+ZS_INTERFACE_EXPORT bool zs_register_worker_thread();
+/// @note must not be called while holding the GIL through GILGuard
+ZS_INTERFACE_EXPORT void zs_unregister_worker_thread();
+/// @brief GIL acquisition counters of GILGuard and GILRelease, accumulated over all threads
+struct ZsGilStats {
+  unsigned long long acquisitions;  // GILGuard actually waiting for the GIL
+  unsigned long long reentries;     // GILGuard on a thread already holding the GIL
+  unsigned long long waitNs;        // total time spent acquiring the GIL
+  unsigned long long maxWaitNs;
+  unsigned long long releases;      // GILRelease scopes actually releasing the GIL
+  unsigned long long threadStates;  // python thread states created by GILGuard or registration
+};
+ZS_INTERFACE_EXPORT void zs_gil_stats(ZsGilStats *stats);
+ZS_INTERFACE_EXPORT void zs_gil_stats_reset();
+
 /// ZsValue query
 ZS_INTERFACE_EXPORT void zs_reflect_value(ZsValue v, const char *msg = "");
 ZS_INTERFACE_EXPORT zs_obj_type_ zs_get_obj_type(ZsValue);
+/// @brief classify the python object held by the value, subclasses of the inherent types included
+/// (e.g. a dict subclass is **zs_obj_type_dict**, bool is **zs_obj_type_long**)
+/// @note zs_get_obj_type only recognizes the exact types, see also ZsTypedObject
+ZS_INTERFACE_EXPORT zs_obj_type_ zs_classify_obj_type(ZsValue);
+/// @brief query the zs_obj_feature_ bits of the python object held by the value, for builtin and
+/// custom types alike (e.g. **zs_obj_feature_iterable** for anything **iter()** accepts)
+/// @note 0 (**zs_obj_feature_none**) if the value is not an object
+ZS_INTERFACE_EXPORT unsigned zs_get_obj_features(ZsValue);
 
 /// ZsValue construction
 /**
@@ -591,6 +1089,27 @@ ZS_INTERFACE_EXPORT ZsValuePort zs_bytearray_obj_cstr(const char *cstr);
 /// @param len the length of the string literal
 ZS_INTERFACE_EXPORT ZsValuePort zs_bytearray_obj_cstr_range(const char *cstr, sint_t len);
 
+// external buffer
+/// @brief callback releasing the externally owned memory \a data, see zs_buffer_obj_external
+/// @note invoked once with the GIL held, after the python object and all views on it are gone
+typedef void (*zs_buffer_release_t)(void *data, void *userData);
+/// @brief return a python object exporting the externally owned host memory \a data through the
+/// buffer protocol without copying (consumable by memoryview, numpy.asarray, ...)
+/// @param format struct module style format of one element (e.g. "f", "d", "q"), "B" if NULL
+/// @param itemsize the size in bytes of one element
+/// @param ndim the number of dimensions (0 for a scalar)
+/// @param shape \a ndim extents
+/// @param strides \a ndim byte strides, C-contiguous if NULL
+/// @param readonly whether python is denied writable views
+/// @param release invoked on \a data and \a userData once the memory is no longer referenced by
+/// python, e.g. to drop the owning container. NULL if the memory outlives the python object.
+/// @note on failure, None is returned and \a release is not invoked
+ZS_INTERFACE_EXPORT ZsValuePort zs_buffer_obj_external(void *data, const char *format,
+                                                       sint_t itemsize, int ndim,
+                                                       const sint_t *shape, const sint_t *strides,
+                                                       bool readonly, zs_buffer_release_t release,
+                                                       void *userData);
+
 // string
 /// @brief return a python **str** object representing \a val
 /// @param val any ZsValue
@@ -627,20 +1146,76 @@ ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_pack_ptrs(sint_t count, ...);
 ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_pack_zsobjs(sint_t count, ...);
 ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_default(long len);
 ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_long(long n);
+/// @brief return a python **tuple** object of \a len unfilled slots, to be filled by
+/// ZsTuple::setItemSteal
+/// @note every slot must be filled before the tuple is handed to python
+ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_sized(sint_t len);
+/// @brief return a python **tuple** object made of the \a count python objects \a items, whose
+/// references are stolen (empty ZsValues become None)
+/// @note the references are released as well on failure, where None is returned
+ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_steal(const ZsValue *items, sint_t count);
 
 // dict
 /// @brief return an empty python **dict** object
 ZS_INTERFACE_EXPORT ZsValuePort zs_dict_obj_default();
 ZS_INTERFACE_EXPORT ZsValuePort zs_dict_obj_copy(ZsDict dict);
+/// @brief return a python **dict** object mapping \a keys[i] to \a values[i], whose references
+/// are stolen. Entries with an empty ZsValue are skipped.
+/// @note the references are released as well on failure, where None is returned
+ZS_INTERFACE_EXPORT ZsValuePort zs_dict_obj_from_keys(const ZsKey *keys, const ZsValue *values,
+                                                      sint_t count);
 
 // list
 /// @brief return an empty python **list** object
 ZS_INTERFACE_EXPORT ZsValuePort zs_list_obj_default();
+/// @brief return a python **list** object of \a len unfilled slots, to be filled by
+/// ZsList::setItemSteal
+/// @note every slot must be filled before the list is handed to python
+ZS_INTERFACE_EXPORT ZsValuePort zs_list_obj_sized(sint_t len);
+/// @brief return a python **list** object made of the \a count python objects \a items, whose
+/// references are stolen (empty ZsValues become None)
+/// @note the references are released as well on failure, where None is returned
+ZS_INTERFACE_EXPORT ZsValuePort zs_list_obj_steal(const ZsValue *items, sint_t count);
+
+// bulk numeric conversion
+/// @brief return a python **list** object holding \a count numbers from the native array \a src
+/// @note the builders below return None on failure
+ZS_INTERFACE_EXPORT ZsValuePort zs_list_obj_from_f64(const double *src, sint_t count);
+ZS_INTERFACE_EXPORT ZsValuePort zs_list_obj_from_f32(const float *src, sint_t count);
+ZS_INTERFACE_EXPORT ZsValuePort zs_list_obj_from_i64(const long long *src, sint_t count);
+ZS_INTERFACE_EXPORT ZsValuePort zs_list_obj_from_i32(const int *src, sint_t count);
+/// @brief return a python **tuple** object holding \a count numbers from the native array \a src
+ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_from_f64(const double *src, sint_t count);
+ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_from_f32(const float *src, sint_t count);
+ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_from_i64(const long long *src, sint_t count);
+ZS_INTERFACE_EXPORT ZsValuePort zs_tuple_obj_from_i32(const int *src, sint_t count);
+/// @brief convert the leading numbers of the python sequence \a seq (list, tuple, buffer
+/// objects such as array.array or numpy arrays, or any sequence of numbers) into \a dst
+/// @param dst caller-provided storage of (at least) \a capacity elements
+/// @return the number of elements written, min(len(seq), capacity), or -1 on failure
+/// @note floats are truncated when converted into integers, out-of-range values are errors.
+/// On failure, a single error is reported for the whole batch and \a dst is partially written.
+/// GIL must be held.
+ZS_INTERFACE_EXPORT sint_t zs_sequence_to_f64(ZsValue seq, double *dst, sint_t capacity);
+ZS_INTERFACE_EXPORT sint_t zs_sequence_to_f32(ZsValue seq, float *dst, sint_t capacity);
+ZS_INTERFACE_EXPORT sint_t zs_sequence_to_i64(ZsValue seq, long long *dst, sint_t capacity);
+ZS_INTERFACE_EXPORT sint_t zs_sequence_to_i32(ZsValue seq, int *dst, sint_t capacity);
 
 // set
 /// @brief return an empty python **set** object
 ZS_INTERFACE_EXPORT ZsValuePort zs_set_obj_default();
 
+// persistent list / map
+/// @brief return an empty persistent list (**zs.PersistentList**), see ZsPList
+ZS_INTERFACE_EXPORT ZsValuePort zs_plist_obj_default();
+/// @brief return a persistent list holding the items of the python iterable \a iterable
+ZS_INTERFACE_EXPORT ZsValuePort zs_plist_obj(ZsValue iterable);
+/// @brief return an empty persistent map (**zs.PersistentMap**), see ZsPMap
+ZS_INTERFACE_EXPORT ZsValuePort zs_pmap_obj_default();
+/// @brief return a persistent map holding the items of \a mapping (a python mapping or an
+/// iterable of pairs)
+ZS_INTERFACE_EXPORT ZsValuePort zs_pmap_obj(ZsValue mapping);
+
 /**
  *  @}
  */
@@ -686,6 +1261,23 @@ template <typename T> constexpr T *as_ptr_(ZsValuePort obj) noexcept {
   @addtogroup obj_types
   @{
   */
+/// @brief a keyword argument of a PyVar call, see zs_kwarg
+struct ZsKwArg {
+  const ZsKey *name;
+  void *value;  // borrowed
+};
+/// @brief make a keyword argument, e.g. var(arr, zs_kwarg(k_axis, axis)), i.e. var(arr, axis=axis)
+/// @note keyword arguments must follow all positional ones
+inline ZsKwArg zs_kwarg(const ZsKey &name, ZsObject value) noexcept {
+  return ZsKwArg{&name, value.handle()};
+}
+inline ZsKwArg zs_kwarg(const ZsKey &name, const PyVar &value) noexcept;
+
+template <typename T> constexpr bool zs_is_kwarg_ = false;
+template <> constexpr bool zs_is_kwarg_<ZsKwArg> = true;
+
+template <typename... Ts> struct ZsCallArgs;
+
 /**
     \~english @brief C++ wrapper class for python object
 
@@ -768,6 +1360,8 @@ struct ZS_INTERFACE_EXPORT PyVar {
   /// @brief query the python object type zs_obj_type_
   /// @note if ZsValue is not an object, **zs_obj_type_unknown** is returned
   zs_obj_type_ get_obj_type() const { return zs_get_obj_type(ZsObject{_obj}); }
+  /// @brief query the zs_obj_feature_ bits of the python object
+  unsigned get_obj_features() const { return zs_get_obj_features(ZsObject{_obj}); }
   /// @brief query if _obj is not a nullptr
   /// @note different from ZsVar
   operator bool() const noexcept { return _obj; }
@@ -817,14 +1411,21 @@ struct ZS_INTERFACE_EXPORT PyVar {
   /// @param obj a python object
   PyVar operator()(ZsObject obj);
   /// @brief call the python callable object with variable arguments
-  /// @param args python object arguments wrapped in ZsValue / ZsObjects / ...
+  /// @param args python object arguments wrapped in ZsValue / ZsObjects / ..., optionally
+  /// followed by keyword arguments made by zs_kwarg
+  /// @note arguments are passed through vectorcall without packing a tuple
   template <typename... Ts> PyVar operator()(Ts... args) {
-    if constexpr (sizeof...(Ts) == 1)
-      return operator()(ZsObject{args}...);
-    else
-      return callObject(zs_tuple_obj_pack_zsobjs(sizeof...(Ts), ZsObject{args}...));
+    if constexpr (sizeof...(Ts) == 1 && ZsCallArgs<Ts...>::nkwargs == 0)
+      return operator()(ZsObject{ZsCallArgs<Ts...>::arg_(args)...});
+    else {
+      ZsCallArgs<Ts...> cargs{args...};
+      return vectorcall(cargs.args, cargs.nargs, cargs.kwnames, cargs.nkwargs);
+    }
   }
   PyVar callObject(ZsTuple args);
+  /// @brief call the python callable object through vectorcall
+  /// @param args argument vector laid out as ZsCallArgs::args, args[0] may be overwritten
+  PyVar vectorcall(void **args, sint_t nargs, const ZsKey *const *kwnames, sint_t nkwargs);
 
   /// @brief call the attribute (which is a python callable object) of name \a method with no
   /// argument
@@ -843,12 +1444,22 @@ struct ZS_INTERFACE_EXPORT PyVar {
   /// @param args python object arguments wrapped in ZsValue / ZsObjects / ...
   /// @note In python, someObj.method(args...)
   template <typename... Ts> PyVar operator()(const char *method, Ts... args) {
-    if constexpr (sizeof...(Ts) == 1)
-      return operator()(method, ZsObject{args}...);
-    else
-      return callMethod(method, zs_tuple_obj_pack_zsobjs(sizeof...(Ts), ZsObject{args}...));
+    ZsCallArgs<Ts...> cargs{args...};
+    return vectorcallMethod(method, cargs.args, cargs.nargs, cargs.kwnames, cargs.nkwargs);
+  }
+  /// @brief call the method named by the interned key \a method with variable arguments
+  /// @note In python, someObj.method(args...)
+  template <typename... Ts> PyVar operator()(const ZsKey &method, Ts... args) {
+    ZsCallArgs<Ts...> cargs{args...};
+    return vectorcallMethod(method, cargs.args, cargs.nargs, cargs.kwnames, cargs.nkwargs);
   }
   PyVar callMethod(const char *method, ZsTuple args);
+  /// @brief call the method \a method through vectorcall, without creating a bound method
+  /// @param args argument vector laid out as ZsCallArgs::args, args[0] is set to this object
+  PyVar vectorcallMethod(const char *method, void **args, sint_t nargs,
+                         const ZsKey *const *kwnames, sint_t nkwargs);
+  PyVar vectorcallMethod(const ZsKey &method, void **args, sint_t nargs,
+                         const ZsKey *const *kwnames, sint_t nkwargs);
 
   /// @brief query if it has an attribute of name \a name
   /// @param name attribute name
@@ -863,6 +1474,11 @@ struct ZS_INTERFACE_EXPORT PyVar {
   /// @brief get the attribute of name \a name
   /// @param name attribute name
   PyVar attr(const char *name);
+  /// @note overloads taking a ZsKey skip the creation and hashing of the name string
+  bool hasAttr(const ZsKey &name);
+  bool setAttr(const ZsKey &name, ZsObject attr);
+  bool delAttr(const ZsKey &name);
+  PyVar attr(const ZsKey &name);
 
   /// @brief query if it has an item of name \a name
   /// @param name item name
@@ -877,6 +1493,10 @@ struct ZS_INTERFACE_EXPORT PyVar {
   /// @brief get the item of name \a name
   /// @param name item name
   PyVar item(const char *name);
+  bool hasItem(const ZsKey &name);
+  bool setItem(const ZsKey &name, ZsObject item);
+  bool delItem(const ZsKey &name);
+  PyVar item(const ZsKey &name);
 
   /// @brief get the repr representation of the stored python object
   PyVar repr();
@@ -890,7 +1510,300 @@ struct ZS_INTERFACE_EXPORT PyVar {
   void *_obj;
 };
 
+inline ZsKwArg zs_kwarg(const ZsKey &name, const PyVar &value) noexcept {
+  return ZsKwArg{&name, value.handle()};
+}
+
+/**
+  @brief stack-allocated argument vector of a vectorcall, generated from the parameter pack
+  @note args[0] is reserved (for self or PY_VECTORCALL_ARGUMENTS_OFFSET), followed by \a nargs
+  positional arguments then \a nkwargs keyword values named by \a kwnames. All borrowed.
+ */
+template <typename... Ts> struct ZsCallArgs {
+  static constexpr sint_t nkwargs = (sint_t{0} + ... + sint_t{zs_is_kwarg_<Ts>});
+  static constexpr sint_t nargs = sizeof...(Ts) - nkwargs;
+  static constexpr bool trailing_kwargs() noexcept {
+    bool kw = false, ok = true;
+    ((ok = ok && (!kw || zs_is_kwarg_<Ts>), kw = kw || zs_is_kwarg_<Ts>), ...);
+    return ok;
+  }
+  static_assert(trailing_kwargs(), "keyword arguments must follow all positional arguments");
+
+  explicit ZsCallArgs(const Ts &...as) noexcept : args{nullptr, arg_(as)...} {
+    sint_t k = 0;
+    (name_(as, k), ...);
+  }
+
+  static void *arg_(const ZsKwArg &a) noexcept { return a.value; }
+  static void *arg_(const PyVar &a) noexcept { return a.handle(); }
+  template <typename T> static void *arg_(const T &a) noexcept { return ZsObject{a}.handle(); }
+  void name_(const ZsKwArg &a, sint_t &k) noexcept { kwnames[k++] = a.name; }
+  template <typename T> void name_(const T &, sint_t &) noexcept {}
+
+  void *args[sizeof...(Ts) + 1];
+  const ZsKey *kwnames[nkwargs + 1];
+};
+
+/// @brief statistics of a cached handle, see ZsAttrHandle
+struct ZsCacheStats {
+  sint_t hits = 0;
+  sint_t misses = 0;    // (re)resolutions that got cached
+  sint_t uncached = 0;  // resolutions of dynamic attributes, which are never cached
+};
+
+/**
+  @brief a cached attribute lookup, i.e. owner.name
+
+  The attribute is resolved once and reused as long as the owner is the same object, its type
+  (and the owner itself if it is a type) keeps the same version tag, and the entry of the name in
+  the owner's **__dict__** is still the same object. Only plain attributes, functions, methods
+  and class/static methods are cached, any other descriptor (properties, custom __get__) or owner
+  customizing attribute access is resolved on every call.
+  \code
+static ZsAttrHandle h_update{"update"};
+PyVar fn = h_update.get(obj);
+  \endcode
+  @note the cached resolution holds references to the owner and the attribute until it is reset
+  or replaced. GIL is required, except for destruction which acquires it (or leaks the references
+  once the interpreter is finalizing).
+ */
+struct ZS_INTERFACE_EXPORT ZsAttrHandle {
+  constexpr ZsAttrHandle(const char *name) noexcept : _name{name} {}
+  ~ZsAttrHandle();
+  ZsAttrHandle(const ZsAttrHandle &) = delete;
+  ZsAttrHandle &operator=(const ZsAttrHandle &) = delete;
+
+  /// @brief get the attribute of \a owner, a null PyVar on failure
+  PyVar get(ZsObject owner);
+  PyVar get(const PyVar &owner) { return get(ZsObject{owner.handle()}); }
+  /// @brief drop the cached resolution
+  void reset();
+
+  const ZsKey &name() const noexcept { return _name; }
+  const ZsCacheStats &stats() const noexcept { return _stats; }
+
+  ZsKey _name;
+  void *_owner{nullptr}, *_type{nullptr}, *_dict{nullptr}, *_entry{nullptr}, *_value{nullptr};
+  unsigned int _typeTag{0}, _ownerTag{0};
+  ZsCacheStats _stats{};
+};
+
+/**
+  @brief a call site owner.method(args...) reusing the callable cached by a ZsAttrHandle
+  \code
+static ZsCallSite cs_eval{"eval"};
+for (auto &e : elements) PyVar r = cs_eval(evaluator, e.pos, zs_kwarg(k_time, t));
+  \endcode
+ */
+struct ZS_INTERFACE_EXPORT ZsCallSite {
+  constexpr ZsCallSite(const char *method) noexcept : _attr{method} {}
+
+  template <typename... Ts> PyVar operator()(ZsObject owner, Ts... args) {
+    PyVar callable = _attr.get(owner);
+    if (!callable) return {};
+    ZsCallArgs<Ts...> cargs{args...};
+    return callable.vectorcall(cargs.args, cargs.nargs, cargs.kwnames, cargs.nkwargs);
+  }
+  template <typename... Ts> PyVar operator()(const PyVar &owner, Ts... args) {
+    return operator()(ZsObject{owner.handle()}, args...);
+  }
+  void reset() { _attr.reset(); }
+  const ZsCacheStats &stats() const noexcept { return _attr.stats(); }
+
+  ZsAttrHandle _attr;
+};
+
 template <typename T> constexpr T *as_ptr_(const PyVar &obj) noexcept { return (T *)(obj._obj); }
+
+/**
+    @brief C++ RAII view on the memory exported by a python object through the buffer protocol
+    (numpy arrays, memoryview, array.array, bytes, bytearray...)
+
+    The buffer is acquired once on construction (PyObject_GetBuffer) and released on destruction
+   (PyBuffer_Release), the exporter is kept alive meanwhile. No data is copied.
+  \code
+ZsBuffer view{obj};
+if (view && view.ndim() == 2 && view.format()[0] == 'f') {
+  auto ptr = static_cast<const float *>(view.data());
+  // ptr[i * view.stride(0) / 4 + j * view.stride(1) / 4]
+}
+  \endcode
+    @note construction and destruction require the GIL, while the memory can be accessed without
+   it (e.g. within a GILRelease scope) as long as the view is held.
+ */
+struct ZS_INTERFACE_EXPORT ZsBuffer {
+  ZsBuffer() noexcept = default;
+  /// @brief acquire a (strided) view of \a obj, a writable one if \a writable is true
+  /// @note the view is invalid if \a obj does not export a (writable) buffer
+  explicit ZsBuffer(ZsValue obj, bool writable = false);
+  ~ZsBuffer();
+  ZsBuffer(const ZsBuffer &) = delete;
+  ZsBuffer &operator=(const ZsBuffer &) = delete;
+  ZsBuffer(ZsBuffer &&o) noexcept : _view{o._view} { o._view = nullptr; }
+  ZsBuffer &operator=(ZsBuffer &&o) noexcept;
+
+  /// @brief release the view early, the view is invalid afterwards
+  void release();
+  /// @brief query if the buffer is acquired
+  bool valid() const noexcept { return _view != nullptr; }
+  explicit operator bool() const noexcept { return valid(); }
+
+  /// @brief get the exporting python object
+  ZsObject obj() const;
+  /// @brief get the address of the first element
+  void *data() const;
+  /// @brief get the total size in bytes (product of shape times itemsize)
+  sint_t size() const;
+  /// @brief get the size in bytes of one element
+  sint_t itemsize() const;
+  /// @brief get the number of elements (product of shape)
+  sint_t count() const;
+  /// @brief get the number of dimensions (0 for a scalar)
+  int ndim() const;
+  /// @brief get the extent of dimension \a dim
+  sint_t shape(int dim) const;
+  /// @brief get the byte stride of dimension \a dim
+  sint_t stride(int dim) const;
+  /// @brief get the struct module style format string of one element (e.g. "d", "<f")
+  const char *format() const;
+  bool readonly() const;
+  /// @brief query if the memory is contiguous in \a order ('C', 'F' or 'A' for either)
+  bool contiguous(char order = 'C') const;
+
+  void *_view{nullptr};  // Py_buffer
+};
+
+/**
+  @brief chunked iteration over any iterable python object (list, tuple, set, dict and its views,
+  generators, custom iterables...), filling a caller-supplied array per call
+  \code
+ZsChunkIterator it{obj};
+ZsObject items[64];
+while (sint_t n = it.next(items, 64)) {
+  if (n < 0) break;  // error, already reported
+  for (sint_t i = 0; i < n; ++i) // items[i] ...
+}
+  \endcode
+  @note items of exact lists, tuples, sets and dicts (keys) are read in place. Borrowed items stay
+  valid until the next call or destruction, provided the container is not mutated meanwhile.
+  GIL must be held.
+ */
+struct ZS_INTERFACE_EXPORT ZsChunkIterator {
+  ZsChunkIterator() noexcept = default;
+  explicit ZsChunkIterator(ZsValue iterable);
+  ~ZsChunkIterator();
+  ZsChunkIterator(const ZsChunkIterator &) = delete;
+  ZsChunkIterator &operator=(const ZsChunkIterator &) = delete;
+
+  /// @brief query if the iteration is set up (i.e. the object is iterable)
+  bool valid() const noexcept { return _src != nullptr; }
+  explicit operator bool() const noexcept { return valid(); }
+
+  /// @brief fill \a dst with up to \a capacity borrowed items
+  /// @return the number of items, 0 once exhausted, -1 on failure
+  sint_t next(ZsObject *dst, sint_t capacity) { return fill(dst, capacity, false); }
+  /// @brief fill \a dst with up to \a capacity items, each a new reference owned by the caller
+  sint_t nextOwned(ZsObject *dst, sint_t capacity) { return fill(dst, capacity, true); }
+
+  sint_t fill(ZsObject *dst, sint_t capacity, bool owned);
+  void releaseHeld();
+
+  void *_src{nullptr};  // the list/tuple/dict read in place, or an iterator
+  void **_held{nullptr};  // references backing the last borrowed chunk
+  sint_t _numHeld{0}, _heldCap{0};
+  sint_t _pos{0}, _size{0};
+  int _kind{0}, _status{0};  // _status: 1 exhausted, -1 failed
+};
+
+namespace zs {
+
+  /// @brief result of try_get, \a value is only meaningful if \a status is zs_error_none
+  template <typename T> struct TryResult {
+    T value{};
+    unsigned status{zs_error_type};
+
+    constexpr bool ok() const noexcept { return status == zs_error_none; }
+    constexpr explicit operator bool() const noexcept { return ok(); }
+    constexpr T value_or(T defl) const noexcept { return ok() ? value : defl; }
+  };
+
+  /**
+    @brief checked conversion of \a v into T (long long, int, char, double, float or const char *)
+    Inline values are read directly from the union, python objects are converted by
+    zs_obj_try_i64 / zs_obj_try_f64. Nothing is printed or recorded on failure.
+    \code
+if (auto r = zs::try_get<double>(item)) sum += r.value;
+int n = zs::try_get<int>(count).value_or(0);
+    \endcode
+    @note integers are not converted from floating point values, narrowing out of the range of T
+    is **zs_error_overflow**. GIL is required for python objects.
+   */
+  template <typename T> TryResult<T> try_get(const ZsValue &v) noexcept {
+    static_assert(std::is_same_v<T, long long> || std::is_same_v<T, int> || std::is_same_v<T, char>
+                      || std::is_same_v<T, double> || std::is_same_v<T, float>
+                      || std::is_same_v<T, const char *>,
+                  "zs::try_get supports long long, int, char, double, float and const char *");
+    if constexpr (std::is_same_v<T, const char *>) {
+      if (v._idx == zs_var_type_cstr) return {v._v.cstr, zs_error_none};
+      return {};
+    } else if constexpr (std::is_integral_v<T>) {
+      long long n;
+      switch (v._idx) {
+        case zs_var_type_i64:
+          n = v._v.i64;
+          break;
+        case zs_var_type_i32:
+          n = v._v.i32;
+          break;
+        case zs_var_type_i8:
+          n = v._v.i8;
+          break;
+        case zs_var_type_object:
+          if (unsigned status = zs_obj_try_i64(v, &n); status != zs_error_none)
+            return {T{}, status};
+          break;
+        default:
+          return {};
+      }
+      if constexpr (!std::is_same_v<T, long long>)
+        if (n < std::numeric_limits<T>::min() || n > std::numeric_limits<T>::max())
+          return {T{}, zs_error_overflow};
+      return {static_cast<T>(n), zs_error_none};
+    } else {
+      double f;
+      switch (v._idx) {
+        case zs_var_type_f64:
+          f = v._v.f64;
+          break;
+        case zs_var_type_f32:
+          f = v._v.f32;
+          break;
+        case zs_var_type_i64:
+          f = static_cast<double>(v._v.i64);
+          break;
+        case zs_var_type_i32:
+          f = v._v.i32;
+          break;
+        case zs_var_type_i8:
+          f = v._v.i8;
+          break;
+        case zs_var_type_object:
+          if (unsigned status = zs_obj_try_f64(v, &f); status != zs_error_none)
+            return {T{}, status};
+          break;
+        default:
+          return {};
+      }
+      if constexpr (std::is_same_v<T, float>) {
+        // infinities and nans are kept, finite values must fit
+        constexpr double lim = std::numeric_limits<float>::max();
+        if ((f > lim || f < -lim) && f - f == 0.0) return {T{}, zs_error_overflow};
+      }
+      return {static_cast<T>(f), zs_error_none};
+    }
+  }
+
+}  // namespace zs
 /**
   @}
   */